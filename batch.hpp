@@ -0,0 +1,171 @@
+#pragma once
+
+// Headless Monte Carlo over sampleDecay(). Events are split into fixed blocks
+// and block b always uses seededRng(seed, b), so a run gives the same numbers
+// (and the same events, see --record-log) whatever the thread count.
+
+#include "decay_sim.hpp"
+#include "histograms.hpp"
+#include "running_stat.hpp"
+#include "sampler.hpp"
+#include "three_body.hpp"
+#include "trace.hpp"
+#include "work_stealing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+constexpr std::uint64_t kBatchBlock = 1u << 16;
+
+struct BatchConfig {
+    std::uint64_t events = 1000000;
+    unsigned threads = 0; // 0: one per hardware thread
+    std::uint64_t seed = 0;
+    Mode mode = Mode::SpinOnly;
+    float leftHandBias = 0.85f;
+    float angleSpread = kAngleSpread;
+    Sampler sampler = Sampler::Pseudo;
+    bool threeBody = false; // proton recoil and correlated antineutrino (ThreeBodyBatch)
+    float polarization = 1.f; // fraction of neutrons with spin up
+    ChannelMix channels;      // decay channels and their weights (default beta- only)
+    double checkpointSeconds = 0.5; // how often onCheckpoint sees merged totals
+
+    // Early stopping: with targetHalfWidth > 0, `events` is only a budget and the
+    // run ends once P(claim looks true) is known to +-targetHalfWidth at the
+    // given confidence. Checked every convergenceSeconds on merged totals; the
+    // stopping point depends on timing, so such runs are not bit-reproducible.
+    double targetHalfWidth = 0.0;
+    double confidence = 0.95;
+    double convergenceSeconds = 0.05;
+};
+
+inline bool batchConverged(const BatchConfig& cfg, const DecayHistograms& h) {
+    if (cfg.targetHalfWidth <= 0.0 || h.events < kBatchBlock) return false;
+    return wilsonHalfWidth(h.claimTrue, h.events, zForConfidence(cfg.confidence)) <= cfg.targetHalfWidth;
+}
+
+// Calls fn(sample) for every event of block b, in order.
+template <class Fn>
+void forEachBlockSample(const BatchConfig& cfg, std::uint64_t b, Fn&& fn) {
+    std::mt19937 rng = seededRng(cfg.seed, b);
+    std::uint64_t first = b * kBatchBlock;
+    std::uint64_t n = std::min(kBatchBlock, cfg.events - first);
+    BlockSampler sampler(cfg.sampler, rng, n, cfg.polarization, cfg.channels);
+    if (cfg.threeBody) {
+        thread_local ThreeBodyBatch batch;
+        batch.run(sampler, rng, n, cfg.leftHandBias, cfg.mode, cfg.angleSpread, fn);
+        return;
+    }
+    for (std::uint64_t i = 0; i < n; ++i) fn(sampler.next(cfg.leftHandBias, cfg.mode, cfg.angleSpread));
+}
+
+// Per-block means, for judging samplers: each block is an independent
+// replicate, so the spread of these across blocks measures estimator noise.
+struct BlockEstimate {
+    std::uint64_t events = 0; // 0: block never ran (early stop)
+    double meanSpinDot = 0.0;
+    double electronSpinUp = 0.0; // fraction with spinE.y >= 0
+    double claimTrue = 0.0;
+};
+
+struct BatchResult {
+    DecayHistograms hist;
+    std::vector<BlockEstimate> blocks;
+};
+
+// Variance of one block estimator across the blocks that ran.
+template <class Get>
+RunningStat blockSpread(const std::vector<BlockEstimate>& blocks, Get get) {
+    RunningStat r;
+    for (const BlockEstimate& e : blocks) {
+        if (e.events == kBatchBlock) r.add(get(e)); // a short tail block would skew the variance
+    }
+    return r;
+}
+
+inline BatchResult runBatch(const BatchConfig& cfg,
+                            const std::function<void(const DecayHistograms&)>& onCheckpoint = {}) {
+    const std::uint64_t blocks = (cfg.events + kBatchBlock - 1) / kBatchBlock;
+    const unsigned nThreads = static_cast<unsigned>(std::min<std::uint64_t>(batchThreads(cfg.threads), std::max<std::uint64_t>(blocks, 1)));
+
+    struct alignas(kCacheLine) Worker {
+        DecayHistograms hist;
+    };
+    std::vector<Worker> workers(nThreads);
+    std::vector<BlockEstimate> estimates(blocks);
+    std::unique_ptr<PublishedHistograms[]> published(new PublishedHistograms[nThreads]);
+    std::atomic<std::uint64_t> nextBlock{0};
+    std::atomic<unsigned> running{nThreads};
+    std::atomic<bool> stop{false};
+
+    auto work = [&](unsigned w) {
+        DecayHistograms& h = workers[w].hist;
+        traceThreadName("batch worker " + std::to_string(w));
+        while (!stop.load(std::memory_order_relaxed)) {
+            std::uint64_t b = nextBlock.fetch_add(1, std::memory_order_relaxed);
+            if (b >= blocks) break;
+            TraceScope span("batch block", static_cast<std::int64_t>(b));
+            double dot = 0.0, up = 0.0;
+            std::uint64_t claims = h.claimTrue;
+            forEachBlockSample(cfg, b, [&](const DecaySample& s) {
+                h.add(s);
+                dot += sampleSpinDot(s);
+                up += (s.spinE.y >= 0.f) ? 1.0 : 0.0;
+            });
+            published[w].publish(h);
+
+            BlockEstimate& e = estimates[b];
+            e.events = std::min(kBatchBlock, cfg.events - b * kBatchBlock);
+            double n = static_cast<double>(e.events);
+            e.meanSpinDot = dot / n;
+            e.electronSpinUp = up / n;
+            e.claimTrue = static_cast<double>(h.claimTrue - claims) / n;
+        }
+        running.fetch_sub(1, std::memory_order_release);
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(nThreads);
+    for (unsigned w = 0; w < nThreads; ++w) pool.emplace_back(work, w);
+
+    const bool adaptive = cfg.targetHalfWidth > 0.0;
+    if (onCheckpoint || adaptive) {
+        using clock = std::chrono::steady_clock;
+        auto secs = [](double s) { return std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(s)); };
+        auto checkpointDue = clock::now() + secs(cfg.checkpointSeconds);
+        auto convergenceDue = clock::now() + secs(cfg.convergenceSeconds);
+
+        while (running.load(std::memory_order_acquire) > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            auto now = clock::now();
+            bool report = onCheckpoint && now >= checkpointDue;
+            bool check = adaptive && now >= convergenceDue;
+            if (!report && !check) continue;
+
+            DecayHistograms total;
+            for (unsigned w = 0; w < nThreads; ++w) published[w].mergeInto(total);
+            if (report) {
+                checkpointDue += secs(cfg.checkpointSeconds);
+                onCheckpoint(total);
+            }
+            if (check) {
+                convergenceDue = now + secs(cfg.convergenceSeconds);
+                if (batchConverged(cfg, total)) stop.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    for (auto& th : pool) th.join();
+
+    BatchResult result;
+    for (const auto& w : workers) result.hist.merge(w.hist);
+    result.blocks = std::move(estimates);
+    return result;
+}
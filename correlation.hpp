@@ -0,0 +1,189 @@
+#pragma once
+
+// Electron-antineutrino angular correlation and helicity asymmetries from the
+// three-body sampler. For the allowed decay the opening angle follows
+//   W(theta) ~ 1 + a beta cos(theta),
+// so E[cos | beta] = a beta / 3 and a = 3 E[beta cos] / E[beta^2]. That ratio
+// is estimated from sums over all events, with a delta-method standard error.
+//
+// Each chunk of ThreeBodyBatch results is reduced in place: per-event terms
+// are formed in plain loops over its arrays and summed pairwise with eight
+// float lanes, which vectorizes without reordering anything. Chunk totals go
+// into Kahan sums per block, and blocks are merged in block order at the end,
+// so the result does not depend on the thread count.
+
+#include "batch.hpp"
+#include "spectrum.hpp"
+#include "three_body.hpp"
+#include "trace.hpp"
+#include "work_stealing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+struct KahanSum {
+    double sum = 0.0;
+    double comp = 0.0; // low-order bits lost from sum, negated
+
+    void add(double x) {
+        double y = x - comp;
+        double t = sum + y;
+        comp = (t - sum) - y;
+        sum = t;
+    }
+
+    void merge(const KahanSum& o) {
+        add(o.sum);
+        add(-o.comp);
+    }
+
+    double value() const { return sum - comp; }
+};
+
+// Sum of x[0..n). Halves down to kBase elements, then adds in eight
+// independent lanes that are combined as a tree; rounding error grows with
+// log n rather than n.
+inline double pairwiseSum(const float* x, int n) {
+    constexpr int kLanes = 8;
+    constexpr int kBase = 64;
+    if (n > kBase) {
+        int half = (n / 2 + kLanes - 1) / kLanes * kLanes;
+        return pairwiseSum(x, half) + pairwiseSum(x + half, n - half);
+    }
+    float lane[kLanes] = {};
+    int i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        for (int j = 0; j < kLanes; ++j) lane[j] += x[i + j];
+    }
+    for (int j = 0; i < n; ++i, ++j) lane[j] += x[i];
+    return ((static_cast<double>(lane[0]) + lane[1]) + (static_cast<double>(lane[2]) + lane[3])) +
+           ((static_cast<double>(lane[4]) + lane[5]) + (static_cast<double>(lane[6]) + lane[7]));
+}
+
+struct CorrelationSums {
+    std::uint64_t events = 0;
+    KahanSum cosine, cosine2;   // cos(theta) of electron and antineutrino directions
+    KahanSum beta;              // electron v/c
+    KahanSum y, y2, x, x2, xy;  // y = beta cos, x = beta^2
+    std::int64_t helicityE = 0; // sum of helicity signs
+    std::int64_t helicityNu = 0;
+
+    void add(const ThreeBodyChunk& c) {
+        const int n = c.size;
+        alignas(ThreeBodyBatch::kLineAlign) float tc[ThreeBodyBatch::kChunk], tc2[ThreeBodyBatch::kChunk];
+        alignas(ThreeBodyBatch::kLineAlign) float tb[ThreeBodyBatch::kChunk];
+        alignas(ThreeBodyBatch::kLineAlign) float ty[ThreeBodyBatch::kChunk], ty2[ThreeBodyBatch::kChunk];
+        alignas(ThreeBodyBatch::kLineAlign) float tx[ThreeBodyBatch::kChunk], tx2[ThreeBodyBatch::kChunk];
+        alignas(ThreeBodyBatch::kLineAlign) float txy[ThreeBodyBatch::kChunk];
+
+        int hE = 0, hN = 0;
+        for (int i = 0; i < n; ++i) {
+            float cs = c.dirEx[i] * c.dirNux[i] + c.dirEy[i] * c.dirNuy[i];
+            float gamma = 1.f + c.energy[i] / kElectronMass;
+            float b = std::sqrt(1.f - 1.f / (gamma * gamma));
+            float yy = b * cs, xx = b * b;
+            tc[i] = cs;
+            tc2[i] = cs * cs;
+            tb[i] = b;
+            ty[i] = yy;
+            ty2[i] = yy * yy;
+            tx[i] = xx;
+            tx2[i] = xx * xx;
+            txy[i] = xx * yy;
+            // helicitySign(): sign of spin dot momentum, 0 counting as +1
+            hE += c.spinEx[i] * c.dirEx[i] + c.spinEy[i] * c.dirEy[i] >= 0.f ? 1 : -1;
+            hN += c.spinNux[i] * c.dirNux[i] + c.spinNuy[i] * c.dirNuy[i] >= 0.f ? 1 : -1;
+        }
+
+        events += static_cast<std::uint64_t>(n);
+        cosine.add(pairwiseSum(tc, n));
+        cosine2.add(pairwiseSum(tc2, n));
+        beta.add(pairwiseSum(tb, n));
+        y.add(pairwiseSum(ty, n));
+        y2.add(pairwiseSum(ty2, n));
+        x.add(pairwiseSum(tx, n));
+        x2.add(pairwiseSum(tx2, n));
+        xy.add(pairwiseSum(txy, n));
+        helicityE += hE;
+        helicityNu += hN;
+    }
+
+    void merge(const CorrelationSums& o) {
+        events += o.events;
+        cosine.merge(o.cosine);
+        cosine2.merge(o.cosine2);
+        beta.merge(o.beta);
+        y.merge(o.y);
+        y2.merge(o.y2);
+        x.merge(o.x);
+        x2.merge(o.x2);
+        xy.merge(o.xy);
+        helicityE += o.helicityE;
+        helicityNu += o.helicityNu;
+    }
+};
+
+struct CorrelationEstimate {
+    std::uint64_t events = 0;
+    double meanCos = 0.0, meanCosErr = 0.0;
+    double meanBeta = 0.0;
+    double a = 0.0, aErr = 0.0; // correlation coefficient, 3 E[beta cos] / E[beta^2]
+    // (N(h = +1) - N(h = -1)) / N per particle
+    double helicityE = 0.0, helicityEErr = 0.0;
+    double helicityNu = 0.0, helicityNuErr = 0.0;
+};
+
+inline CorrelationEstimate estimateCorrelation(const CorrelationSums& s) {
+    CorrelationEstimate e;
+    e.events = s.events;
+    if (s.events < 2) return e;
+    const double n = static_cast<double>(s.events);
+    auto cov = [&](const KahanSum& ab, double ma, double mb) { return (ab.value() - n * ma * mb) / (n - 1.0); };
+
+    e.meanCos = s.cosine.value() / n;
+    e.meanCosErr = std::sqrt(std::max(0.0, cov(s.cosine2, e.meanCos, e.meanCos)) / n);
+    e.meanBeta = s.beta.value() / n;
+
+    double my = s.y.value() / n, mx = s.x.value() / n;
+    if (mx > 0.0) {
+        double r = my / mx;
+        double v = cov(s.y2, my, my) - 2.0 * r * cov(s.xy, mx, my) + r * r * cov(s.x2, mx, mx);
+        e.a = 3.0 * r;
+        e.aErr = 3.0 * std::sqrt(std::max(0.0, v) / n) / mx;
+    }
+
+    auto asymmetry = [&](std::int64_t sum, double& value, double& err) {
+        value = static_cast<double>(sum) / n;
+        err = std::sqrt(std::max(0.0, 1.0 - value * value) / n);
+    };
+    asymmetry(s.helicityE, e.helicityE, e.helicityEErr);
+    asymmetry(s.helicityNu, e.helicityNu, e.helicityNuErr);
+    return e;
+}
+
+// Samples cfg.events three-body decays (the events --batch --three-body sees
+// for the same settings) and reduces them. Block b is reduced on whichever
+// worker takes it into its own slot, and the slots are merged in block order.
+inline CorrelationSums runCorrelation(const BatchConfig& cfg) {
+    const std::uint64_t blocks = (cfg.events + kBatchBlock - 1) / kBatchBlock;
+    std::vector<CorrelationSums> partial(static_cast<std::size_t>(blocks));
+
+    runWorkStealing(static_cast<std::size_t>(blocks), batchThreads(cfg.threads), [&](std::size_t task, unsigned) {
+        TraceScope span("correlation block", static_cast<std::int64_t>(task));
+        std::uint64_t b = task;
+        std::mt19937 rng = seededRng(cfg.seed, b);
+        std::uint64_t n = std::min(kBatchBlock, cfg.events - b * kBatchBlock);
+        BlockSampler sampler(cfg.sampler, rng, n, cfg.polarization, cfg.channels);
+        thread_local ThreeBodyBatch batch;
+        CorrelationSums& out = partial[task];
+        batch.runChunks(sampler, rng, n, cfg.leftHandBias, cfg.mode, cfg.angleSpread,
+                        [&](const ThreeBodyChunk& c) { out.add(c); });
+    });
+
+    CorrelationSums total;
+    for (const CorrelationSums& p : partial) total.merge(p);
+    return total;
+}
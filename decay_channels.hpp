@@ -0,0 +1,353 @@
+#pragma once
+
+// The decay channels the generator knows, as one table of flat arrays indexed
+// by channel id. Everything channel specific (which lepton leaves, the
+// helicity it prefers, the neutrino's forced helicity, whether the charged
+// lepton's spin counts with the initial or the final state, Q and the
+// correlation coefficients) is looked up by id inside the sampling loops, so a
+// run mixing channels goes through the same code as a single-channel run:
+// no virtual calls, no per-event string handling. Names are only compared
+// when parsing the command line.
+//
+// Each channel uses one well-known decay as its example:
+//   beta-  n -> p e- anti-nu            Q = 0.782 MeV, a = -0.106, A = -0.118
+//   beta+  F-18 -> O-18 e+ nu           Q = 0.634 MeV, pure Gamow-Teller, a = -1/3, A = +1
+//   EC     Be-7 + e- -> Li-7 nu         Q = 0.862 MeV, one monoenergetic neutrino
+
+#include "spectrum.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+enum class Channel : std::uint8_t { BetaMinus = 0, BetaPlus = 1, ElectronCapture = 2 };
+
+// Rows 0..2 of every table are the built-in channels, in Channel order.
+constexpr std::uint8_t kBuiltInChannels = 3;
+
+// Free neutron electron-antineutrino correlation: W(theta) ~ 1 + a beta cos(theta).
+constexpr float kCorrelationA = -0.1059f;
+
+// Free neutron beta asymmetry: the electron leaves along the neutron spin with
+// W ~ 1 + A beta cos(spin, electron), so mostly against it.
+constexpr float kBetaAsymmetryA = -0.1180f;
+
+// What a channel is, whatever row it ended up in: the parent nucleus and the
+// decay kind. Logs store these rather than row ids, which depend on the
+// --nuclide list of the run that wrote them.
+struct ChannelKey {
+    std::uint16_t z = 0;
+    std::uint16_t a = 0;
+    std::uint8_t kind = 0; // Channel
+    std::uint8_t reserved[3] = {};
+};
+
+static_assert(sizeof(ChannelKey) == 8, "channel key layout changed");
+
+inline bool operator==(const ChannelKey& l, const ChannelKey& r) { return l.z == r.z && l.a == r.a && l.kind == r.kind; }
+
+// "Z=27 A=60 beta-", for errors about channels a log needs.
+inline std::string channelKeyName(const ChannelKey& k) {
+    static const char* const kinds[] = {"beta-", "beta+", "ec"};
+    return "Z=" + std::to_string(k.z) + " A=" + std::to_string(k.a) + " " + (k.kind < 3 ? kinds[k.kind] : "?");
+}
+
+// One channel as the table stores it, for building and extending the table.
+struct ChannelInfo {
+    ChannelKey identity;
+    std::string key, title; // command-line name; reaction for the HUD and batch headers
+    std::string parentLabel, daughterLabel, chargedLabel, neutralLabel;
+    std::string chargedName, neutralName; // Particle::name
+    std::string detail;                   // spins, parities, transition type, half-life
+    sf::Color chargedColor, neutralColor;
+    float chargedHelicity = -1.f, neutralHelicity = 1.f;
+    int chargedSide = -1;
+    int parentTwoJ = 1, daughterTwoJ = 1;
+    float q = 0.f, correlationA = 0.f, asymmetryA = 0.f;
+    const BetaSpectrum* spectrum = nullptr;
+};
+
+struct DecayChannels {
+    static constexpr int kMax = 16;
+
+    int count = 0;
+    std::array<ChannelKey, kMax> identity{};
+    std::array<std::string, kMax> key, title;
+    std::array<std::string, kMax> parentLabel, daughterLabel, chargedLabel, neutralLabel;
+    std::array<std::string, kMax> chargedName, neutralName;
+    std::array<std::string, kMax> detail;
+    std::array<sf::Color, kMax> chargedColor{}, neutralColor{};
+
+    // The charged lepton gets chargedHelicity with probability leftHandBias
+    // (left-handed e-, right-handed e+); the neutrino always has neutralHelicity.
+    std::array<float, kMax> chargedHelicity{};
+    std::array<float, kMax> neutralHelicity{};
+    // -1: the charged lepton is emitted. +1: it is captured, so it does not
+    // move and its spin counts with the parent's.
+    std::array<int, kMax> chargedSide{};
+    // Twice the nuclear spins, so the neutron and proton are 1 and L_needed
+    // stays in units of hbar/2 like the lepton spins.
+    std::array<int, kMax> parentTwoJ{}, daughterTwoJ{};
+
+    std::array<float, kMax> q{};            // MeV shared by the leptons
+    std::array<float, kMax> correlationA{}; // lepton-neutrino correlation a
+    std::array<float, kMax> asymmetryA{};   // charged lepton asymmetry A against the parent spin
+    std::array<const BetaSpectrum*, kMax> spectrum{}; // nullptr: no charged lepton emitted
+
+    // Id of the new row, or -1 when the table is full.
+    int add(const ChannelInfo& c) {
+        if (count >= kMax) return -1;
+        const std::size_t i = static_cast<std::size_t>(count);
+        identity[i] = c.identity;
+        key[i] = c.key;
+        title[i] = c.title;
+        parentLabel[i] = c.parentLabel;
+        daughterLabel[i] = c.daughterLabel;
+        chargedLabel[i] = c.chargedLabel;
+        neutralLabel[i] = c.neutralLabel;
+        chargedName[i] = c.chargedName;
+        neutralName[i] = c.neutralName;
+        detail[i] = c.detail;
+        chargedColor[i] = c.chargedColor;
+        neutralColor[i] = c.neutralColor;
+        chargedHelicity[i] = c.chargedHelicity;
+        neutralHelicity[i] = c.neutralHelicity;
+        chargedSide[i] = c.chargedSide;
+        parentTwoJ[i] = c.parentTwoJ;
+        daughterTwoJ[i] = c.daughterTwoJ;
+        q[i] = c.q;
+        correlationA[i] = c.correlationA;
+        asymmetryA[i] = c.asymmetryA;
+        spectrum[i] = c.spectrum;
+        return count++;
+    }
+
+    ChannelInfo row(std::size_t i) const {
+        ChannelInfo c;
+        c.identity = identity[i];
+        c.key = key[i];
+        c.title = title[i];
+        c.parentLabel = parentLabel[i];
+        c.daughterLabel = daughterLabel[i];
+        c.chargedLabel = chargedLabel[i];
+        c.neutralLabel = neutralLabel[i];
+        c.chargedName = chargedName[i];
+        c.neutralName = neutralName[i];
+        c.detail = detail[i];
+        c.chargedColor = chargedColor[i];
+        c.neutralColor = neutralColor[i];
+        c.chargedHelicity = chargedHelicity[i];
+        c.neutralHelicity = neutralHelicity[i];
+        c.chargedSide = chargedSide[i];
+        c.parentTwoJ = parentTwoJ[i];
+        c.daughterTwoJ = daughterTwoJ[i];
+        c.q = q[i];
+        c.correlationA = correlationA[i];
+        c.asymmetryA = asymmetryA[i];
+        c.spectrum = spectrum[i];
+        return c;
+    }
+};
+
+// Beta asymmetry of a pure Gamow-Teller transition J -> J': A = -+lambda for
+// beta-/beta+, with lambda 1 for J' = J - 1, 1/(J + 1) for J' = J and
+// -J/(J + 1) for J' = J + 1.
+inline float gamowTellerAsymmetry(int parentTwoJ, int daughterTwoJ, bool betaMinus) {
+    float j = 0.5f * static_cast<float>(parentTwoJ);
+    float lambda = 0.f;
+    if (daughterTwoJ == parentTwoJ - 2) lambda = 1.f;
+    else if (daughterTwoJ == parentTwoJ) lambda = j > 0.f ? 1.f / (j + 1.f) : 0.f;
+    else if (daughterTwoJ == parentTwoJ + 2) lambda = -j / (j + 1.f);
+    return betaMinus ? -lambda : lambda;
+}
+
+// Each row starts from a fresh ChannelInfo and sets every field, so nothing
+// carries over from the row before.
+inline DecayChannels buildDecayChannels() {
+    static const BetaSpectrum fluorine18(0.6335f, -8); // positron against the O-18 charge
+
+    DecayChannels t;
+
+    // Same order as Channel.
+    {
+        ChannelInfo c;
+        c.identity.z = 0;
+        c.identity.a = 1;
+        c.identity.kind = static_cast<std::uint8_t>(Channel::BetaMinus);
+        c.key = "beta-";
+        c.title = "beta- (n -> p e- anti-nu)";
+        c.parentLabel = "Neutron";
+        c.daughterLabel = "Proton";
+        c.chargedLabel = "Electron";
+        c.neutralLabel = "Anti-neutrino";
+        c.chargedName = "e-";
+        c.neutralName = "anti-nu";
+        c.detail = "1/2+ -> 1/2+, allowed mixed, T1/2 10.2 min";
+        c.chargedColor = sf::Color(240, 210, 80);
+        c.neutralColor = sf::Color(120, 190, 255);
+        c.chargedHelicity = -1.f;
+        c.neutralHelicity = +1.f;
+        c.chargedSide = -1;
+        c.parentTwoJ = 1;
+        c.daughterTwoJ = 1;
+        c.q = kNeutronQ;
+        c.correlationA = kCorrelationA;
+        c.asymmetryA = kBetaAsymmetryA;
+        c.spectrum = &neutronSpectrum();
+        t.add(c);
+    }
+    {
+        ChannelInfo c;
+        c.identity.z = 9;
+        c.identity.a = 18;
+        c.identity.kind = static_cast<std::uint8_t>(Channel::BetaPlus);
+        c.key = "beta+";
+        c.title = "beta+ (F-18 -> O-18 e+ nu)";
+        c.parentLabel = "F-18";
+        c.daughterLabel = "O-18";
+        c.chargedLabel = "Positron";
+        c.neutralLabel = "Neutrino";
+        c.chargedName = "e+";
+        c.neutralName = "nu";
+        c.detail = "1+ -> 0+, allowed Gamow-Teller, T1/2 110 min";
+        c.chargedColor = sf::Color(120, 230, 160);
+        c.neutralColor = sf::Color(200, 150, 255);
+        c.chargedHelicity = +1.f;
+        c.neutralHelicity = -1.f;
+        c.chargedSide = -1;
+        c.parentTwoJ = 2;
+        c.daughterTwoJ = 0;
+        c.q = 0.6335f;
+        c.correlationA = -1.f / 3.f;
+        c.asymmetryA = gamowTellerAsymmetry(c.parentTwoJ, c.daughterTwoJ, false); // +1: the positron follows the spin
+        c.spectrum = &fluorine18;
+        t.add(c);
+    }
+    {
+        // Nothing charged leaves, so there is no correlation or asymmetry to draw.
+        ChannelInfo c;
+        c.identity.z = 4;
+        c.identity.a = 7;
+        c.identity.kind = static_cast<std::uint8_t>(Channel::ElectronCapture);
+        c.key = "ec";
+        c.title = "EC (Be-7 + e- -> Li-7 nu)";
+        c.parentLabel = "Be-7";
+        c.daughterLabel = "Li-7";
+        c.chargedLabel = "Captured e-";
+        c.neutralLabel = "Neutrino";
+        c.chargedName = "e-";
+        c.neutralName = "nu";
+        c.detail = "3/2- -> 3/2-, allowed mixed, T1/2 53.2 d";
+        c.chargedColor = sf::Color(240, 210, 80);
+        c.neutralColor = sf::Color(200, 150, 255);
+        c.chargedHelicity = -1.f;
+        c.neutralHelicity = -1.f;
+        c.chargedSide = +1;
+        c.parentTwoJ = 3;
+        c.daughterTwoJ = 3;
+        c.q = 0.8618f;
+        c.correlationA = 0.f;
+        c.asymmetryA = 0.f;
+        c.spectrum = nullptr;
+        t.add(c);
+    }
+    return t;
+}
+
+// Built on first use (start-up in practice). addDecayChannel() may extend it
+// until the first sampling thread starts; it is read-only from then on.
+inline DecayChannels& decayChannelTable() {
+    static DecayChannels t = buildDecayChannels();
+    return t;
+}
+
+inline const DecayChannels& decayChannels() { return decayChannelTable(); }
+
+inline int addDecayChannel(const ChannelInfo& c) { return decayChannelTable().add(c); }
+
+// By command-line key, or by parent ("F-18" finds the built-in beta+ row).
+inline bool findChannel(const std::string& key, std::uint8_t& id) {
+    const DecayChannels& t = decayChannels();
+    for (int i = 0; i < t.count; ++i) {
+        const std::size_t r = static_cast<std::size_t>(i);
+        if (key == t.key[r] || key == t.parentLabel[r]) {
+            id = static_cast<std::uint8_t>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Row holding channel k, or -1 if this run has not loaded it.
+inline int findChannel(const ChannelKey& k) {
+    const DecayChannels& t = decayChannels();
+    for (int i = 0; i < t.count; ++i) {
+        if (t.identity[static_cast<std::size_t>(i)] == k) return i;
+    }
+    return -1;
+}
+
+// Which channels a batch draws from and how often. A single channel needs no
+// draw, so the default (beta- only) keeps the random streams of older runs.
+struct ChannelMix {
+    int count = 1;
+    std::array<std::uint8_t, DecayChannels::kMax> id{};
+    std::array<float, DecayChannels::kMax> cdf{{1.f}};
+
+    bool needsDraw() const { return count > 1; }
+    std::uint8_t first() const { return id[0]; }
+
+    // u uniform on [0, 1).
+    std::uint8_t pick(float u) const {
+        int i = 0;
+        while (i + 1 < count && u >= cdf[static_cast<std::size_t>(i)]) ++i;
+        return id[static_cast<std::size_t>(i)];
+    }
+};
+
+// "beta-", or weighted "beta-:0.5,beta+:0.3,ec:0.2" (weights need not add up to 1).
+inline bool parseChannelMix(const std::string& text, ChannelMix& out) {
+    ChannelMix mix;
+    mix.count = 0;
+    float total = 0.f;
+    std::array<float, DecayChannels::kMax> weight{};
+    std::size_t pos = 0;
+    while (pos <= text.size()) {
+        std::size_t end = text.find(',', pos);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        float w = 1.f;
+        std::size_t colon = item.find(':');
+        if (colon != std::string::npos) {
+            char* stop = nullptr;
+            std::string ws = item.substr(colon + 1);
+            w = std::strtof(ws.c_str(), &stop);
+            if (ws.empty() || *stop != '\0' || !(w > 0.f)) return false;
+            item.resize(colon);
+        }
+        std::uint8_t id = 0;
+        if (!findChannel(item, id) || mix.count >= DecayChannels::kMax) return false;
+        for (int i = 0; i < mix.count; ++i) {
+            if (mix.id[static_cast<std::size_t>(i)] == id) return false;
+        }
+        mix.id[static_cast<std::size_t>(mix.count)] = id;
+        weight[static_cast<std::size_t>(mix.count)] = w;
+        ++mix.count;
+        total += w;
+    }
+
+    float run = 0.f;
+    for (int i = 0; i < mix.count; ++i) {
+        run += weight[static_cast<std::size_t>(i)];
+        mix.cdf[static_cast<std::size_t>(i)] = run / total;
+    }
+    mix.cdf[static_cast<std::size_t>(mix.count - 1)] = 1.f;
+    out = mix;
+    return true;
+}
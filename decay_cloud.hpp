@@ -0,0 +1,167 @@
+#pragma once
+
+// Many decays on screen at once, for the cloud view. Each slot holds one
+// decay from makeEvent() placed somewhere in the arena; when it has played
+// for its duration the slot gets a fresh decay at a new place. Slots keep only
+// what drawing needs, in one flat array: no strings, and trails in a fixed
+// ring per lepton instead of a growing vector, so tens of thousands of decays
+// step without allocating.
+
+#include "decay_sim.hpp"
+#include "histograms.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// How much of the cloud is drawn, most first. Detail is given up in this
+// order as the frame budget runs out; the last level keeps one spin tick per
+// lepton so the spread of spin directions stays visible.
+enum class CloudDetail : std::uint8_t { Full = 0, NoGlow = 1, NoLabels = 2, NoTrails = 3, SpinTicks = 4 };
+constexpr int kCloudDetailLevels = 5;
+
+inline const char* cloudDetailName(CloudDetail d) {
+    static const char* const names[kCloudDetailLevels] = {"full", "no glow", "no labels", "no trails", "spin ticks only"};
+    return names[static_cast<int>(d)];
+}
+
+struct CloudLepton {
+    static constexpr int kTrail = 6;            // points kept
+    static constexpr float kTrailStep = 0.015f; // seconds between them, about one a frame
+
+    sf::Vector2f pos, vel, spin;
+    std::array<sf::Vector2f, kTrail> trail;
+    int trailHead = 0; // next point to overwrite
+    int trailCount = 0;
+    float trailTimer = 0.f;
+
+    // i = 0 is the oldest point kept.
+    sf::Vector2f trailPoint(int i) const {
+        return trail[static_cast<std::size_t>((trailHead - trailCount + i + kTrail) % kTrail)];
+    }
+};
+
+struct CloudDecay {
+    CloudLepton charged, neutral;
+    sf::Vector2f parentPos, daughterPos, daughterVel;
+    float age = 0.f, duration = 3.f;
+    int parentSpinSign = +1;
+    int L_needed = 0;
+    std::uint8_t channel = 0;
+    bool claimTrue = false; // spins look opposite; they do not change in flight
+};
+
+class DecayCloud {
+public:
+    static constexpr std::size_t kMinSize = 100, kDefaultSize = 2000, kMaxSize = 64000;
+    static constexpr float kRadius = 3.f;  // lepton size on screen, for the walls
+    static constexpr float kMargin = 40.f; // decays start this far inside the arena
+
+    // Resizes to n decays. New slots get spawn(origin) -> DecayEvent at a
+    // random place and a random age, so the cloud does not pulse in step.
+    template <class Spawn>
+    void resize(std::size_t n, std::mt19937& rng, const sf::FloatRect& arena, Spawn&& spawn) {
+        std::size_t old = decays_.size();
+        decays_.resize(n);
+        for (std::size_t i = old; i < n; ++i) place(decays_[i], rng, arena, spawn, true);
+    }
+
+    // Replaces every decay, e.g. after the mode or channel changed.
+    template <class Spawn>
+    void refill(std::mt19937& rng, const sf::FloatRect& arena, Spawn&& spawn) {
+        for (CloudDecay& d : decays_) place(d, rng, arena, spawn, true);
+    }
+
+    template <class Spawn>
+    void advance(float dt, std::mt19937& rng, const sf::FloatRect& arena, Spawn&& spawn) {
+        if (dt <= 0.f) return;
+        for (CloudDecay& d : decays_) {
+            d.age += dt;
+            if (d.age >= d.duration) {
+                place(d, rng, arena, spawn, false);
+                continue;
+            }
+            step(d.charged, dt, arena);
+            step(d.neutral, dt, arena);
+            drift(d, dt, arena);
+        }
+    }
+
+    void clear() { decays_.clear(); }
+    std::size_t size() const { return decays_.size(); }
+    bool empty() const { return decays_.empty(); }
+    const std::vector<CloudDecay>& decays() const { return decays_; }
+
+private:
+    template <class Spawn>
+    static void place(CloudDecay& d, std::mt19937& rng, const sf::FloatRect& arena, Spawn& spawn, bool randomAge) {
+        std::uniform_real_distribution<float> u01(0.f, 1.f);
+        sf::Vector2f origin{arena.position.x + kMargin + (arena.size.x - 2.f * kMargin) * u01(rng),
+                            arena.position.y + kMargin + (arena.size.y - 2.f * kMargin) * u01(rng)};
+        const DecayEvent ev = spawn(origin);
+
+        d.charged = lepton(ev.electron);
+        d.neutral = lepton(ev.antinu);
+        d.parentPos = origin;
+        d.daughterPos = origin;
+        d.daughterVel = ev.protonVel;
+        d.duration = ev.duration;
+        d.parentSpinSign = ev.neutronSpinSign;
+        d.L_needed = ev.L_needed;
+        d.channel = ev.channel;
+        d.claimTrue = claimLooksTrue(vdot(vnorm(ev.electron.spinDir), vnorm(ev.antinu.spinDir)));
+
+        // Starting mid-flight: one long step, walls included.
+        d.age = randomAge ? ev.duration * u01(rng) : 0.f;
+        if (d.age > 0.f) {
+            step(d.charged, d.age, arena);
+            step(d.neutral, d.age, arena);
+            drift(d, d.age, arena);
+        }
+    }
+
+    static CloudLepton lepton(const Particle& p) {
+        CloudLepton l;
+        l.pos = p.pos;
+        l.vel = p.vel;
+        l.spin = vnorm(p.spinDir);
+        return l;
+    }
+
+    // Same motion as the single view's particles.
+    static void step(CloudLepton& p, float dt, const sf::FloatRect& arena) {
+        p.pos += p.vel * dt;
+
+        p.trailTimer += dt;
+        if (p.trailTimer >= CloudLepton::kTrailStep) {
+            p.trailTimer = 0.f;
+            p.trail[static_cast<std::size_t>(p.trailHead)] = p.pos;
+            p.trailHead = (p.trailHead + 1) % CloudLepton::kTrail;
+            if (p.trailCount < CloudLepton::kTrail) ++p.trailCount;
+        }
+
+        bounce(p.pos, p.vel, arena);
+    }
+
+    // The recoiling daughter stays in the arena too; with one decay on screen
+    // it never gets that far, with thousands some start near a wall.
+    static void drift(CloudDecay& d, float dt, const sf::FloatRect& arena) {
+        d.daughterPos += d.daughterVel * dt;
+        bounce(d.daughterPos, d.daughterVel, arena);
+    }
+
+    static void bounce(sf::Vector2f& pos, sf::Vector2f& vel, const sf::FloatRect& arena) {
+        const float left = arena.position.x + kRadius, right = arena.position.x + arena.size.x - kRadius;
+        const float top = arena.position.y + kRadius, bottom = arena.position.y + arena.size.y - kRadius;
+        if (pos.x < left) { pos.x = left; vel.x *= -1.f; }
+        if (pos.x > right) { pos.x = right; vel.x *= -1.f; }
+        if (pos.y < top) { pos.y = top; vel.y *= -1.f; }
+        if (pos.y > bottom) { pos.y = bottom; vel.y *= -1.f; }
+    }
+
+    std::vector<CloudDecay> decays_;
+};
@@ -0,0 +1,291 @@
+#pragma once
+
+// Simulation core shared by the interactive view and the command line tools:
+// vector helpers, the particle/event structs and the toy decay generator.
+
+#include "decay_channels.hpp"
+#include "spectrum.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+inline float vlen(sf::Vector2f v) { return std::sqrt(v.x * v.x + v.y * v.y); }
+inline sf::Vector2f vnorm(sf::Vector2f v) {
+    float l = vlen(v);
+    if (l <= 1e-6f) return {0.f, 0.f};
+    return {v.x / l, v.y / l};
+}
+inline float vdot(sf::Vector2f a, sf::Vector2f b) { return a.x * b.x + a.y * b.y; }
+inline sf::Vector2f vperp(sf::Vector2f v) { return {-v.y, v.x}; }
+
+struct Particle {
+    std::string name;
+    sf::Vector2f pos;
+    sf::Vector2f vel;     // momentum direction is normalized vel
+    sf::Vector2f spinDir; // spin direction unit vector
+    float radius = 8.f;
+    sf::Color color = sf::Color::White;
+
+    std::vector<sf::Vector2f> trail;
+    float trailTimer = 0.f;
+};
+
+// electron and antinu are the charged lepton and the neutrino of whatever
+// channel the event has (e+ and nu for beta+, for example).
+struct DecayEvent {
+    Particle electron;
+    Particle antinu;
+    std::uint8_t channel = 0; // index into decayChannels()
+    int protonSpinSign = 0;   // toy +1 or -1; for a nucleus the sign of the daughter's spin
+    int neutronSpinSign = +1; // sign of the parent's spin; 2J of both comes from the channel
+    int L_needed = 0;         // toy orbital term
+    float electronT = -1.f;   // kinetic energy in MeV, < 0 if not sampled
+    sf::Vector2f protonPos;
+    sf::Vector2f protonVel; // recoil, exaggerated (kRecoilPxPerMeV)
+    float timeAlive = 0.f;
+    float duration = 3.0f;
+};
+
+enum class Mode {
+    SpinOnly = 1,      // deliberately oversimplified: "spins always cancel"
+    SpinAndMotion = 2, // show momentum + helicity
+    FullConservation = 3 // show orbital placeholder L_needed
+};
+
+// The physics part of one decay without any render state (names, colours,
+// trails). This is what the batch tools work with and what event logs store.
+struct DecaySample {
+    sf::Vector2f dirE;
+    sf::Vector2f spinE;
+    sf::Vector2f dirNu;
+    sf::Vector2f spinNu;
+    int protonSpinSign = 0;
+    int neutronSpinSign = +1;
+    int L_needed = 0;
+    std::uint8_t channel = 0;        // index into decayChannels()
+    float electronT = -1.f;          // kinetic energy in MeV, < 0 for two-body samples
+    sf::Vector2f recoil{0.f, 0.f};   // proton momentum in MeV/c, zero for two-body samples
+};
+
+// Deterministic generator for a 64-bit seed. stream picks an independent
+// sequence for the same seed (one per batch block or worker).
+inline std::mt19937 seededRng(std::uint64_t seed, std::uint64_t stream = 0) {
+    std::seed_seq seq{
+        static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+        static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32),
+    };
+    return std::mt19937(seq);
+}
+
+inline int signf(float x) { return (x >= 0.f) ? 1 : -1; }
+
+inline int helicitySign(const sf::Vector2f& spinDir, const sf::Vector2f& momDir) {
+    // helicity sign is sign(spin dot momentum)
+    return signf(vdot(spinDir, momDir));
+}
+
+// Half-width in radians of the electron emission cone around +x.
+constexpr float kAngleSpread = 0.35f;
+
+// Neutron spin sign from a uniform draw: +1 (up) with probability
+// polarization, the spin-up fraction of the sample.
+inline int neutronSignFromDraw(float uSpin, float polarization) { return uSpin < polarization ? +1 : -1; }
+
+// A fully polarized sample (the default) needs no spin draw, which keeps the
+// streams of seeds and event logs from before polarization existed.
+inline bool needsSpinDraw(float polarization) { return polarization < 1.f; }
+
+// The part of a decay every mode shares: uAngle and uLeft uniform on [0, 1),
+// protonSign and neutronSign +-1, channel an id from decayChannels().
+// applyMode() then adds the mode's rules and L_needed.
+inline DecaySample decayGeometry(float uAngle, float uLeft, int protonSign, float leftHandBias,
+                                 float angleSpread = kAngleSpread, int neutronSign = +1, std::uint8_t channel = 0) {
+    const DecayChannels& ch = decayChannels();
+    DecaySample s;
+    s.neutronSpinSign = neutronSign;
+    s.channel = channel;
+
+    // Mostly rightward electron momentum
+    float a = -angleSpread + (angleSpread + angleSpread) * uAngle;
+    sf::Vector2f dirE(std::cos(a), std::sin(a));
+    s.dirE = vnorm(dirE);
+    s.dirNu = vnorm(-s.dirE);
+
+    // Charged lepton spin: biased toward the channel's helicity (left-handed
+    // e-, right-handed e+) for Mode >= 2
+    float h = ch.chargedHelicity[channel];
+    bool preferred = (uLeft < leftHandBias);
+    s.spinE = vnorm(s.dirE * (preferred ? h : -h));
+
+    // Neutrino forced to its helicity (right-handed anti-nu, left-handed nu) for Mode >= 2
+    s.spinNu = vnorm(s.dirNu * ch.neutralHelicity[channel]);
+
+    s.protonSpinSign = protonSign;
+    return s;
+}
+
+inline DecaySample applyMode(DecaySample s, Mode mode) {
+    // MODE 1: enforce the oversimplified myth visually: spins are always opposite.
+    // Hide the real relationship between helicity and motion by construction.
+    if (mode == Mode::SpinOnly) {
+        // Keep motion for animation, but force spin cancellation in "space":
+        s.spinNu = vnorm(-s.spinE);
+    }
+
+    // Toy integer bookkeeping for L_needed (used in Mode 3 as "orbital placeholder"),
+    // in units of hbar/2: the nuclei count 2J times their spin sign, the leptons
+    // one each. A captured electron's spin is on the initial side.
+    const DecayChannels& ch = decayChannels();
+    const std::size_t id = s.channel;
+    int sP = s.protonSpinSign;
+    int sE = (s.spinE.y >= 0.f) ? +1 : -1;
+    int sN = (s.spinNu.y >= 0.f) ? +1 : -1;
+    s.L_needed = ch.parentTwoJ[id] * s.neutronSpinSign - (ch.daughterTwoJ[id] * sP + sN) + ch.chargedSide[id] * sE;
+
+    return s;
+}
+
+inline DecaySample decayFromUniforms(float uAngle, float uLeft, int protonSign, float leftHandBias, Mode mode,
+                                     float angleSpread = kAngleSpread, int neutronSign = +1, std::uint8_t channel = 0) {
+    return applyMode(decayGeometry(uAngle, uLeft, protonSign, leftHandBias, angleSpread, neutronSign, channel), mode);
+}
+
+inline DecaySample sampleDecay(std::mt19937& rng, float leftHandBias, Mode mode, float angleSpread = kAngleSpread,
+                               float polarization = 1.f, std::uint8_t channel = 0) {
+    std::uniform_real_distribution<float> u01(0.f, 1.f);
+    std::uniform_int_distribution<int> pm01(0, 1);
+
+    // Draw order is part of the seed contract (event logs, --seed); keep it.
+    float uAngle = u01(rng);
+    float uLeft = u01(rng);
+    int protonSign = pm01(rng) ? +1 : -1;
+    int neutronSign = needsSpinDraw(polarization) ? neutronSignFromDraw(u01(rng), polarization) : +1;
+    return decayFromUniforms(uAngle, uLeft, protonSign, leftHandBias, mode, angleSpread, neutronSign, channel);
+}
+
+// cos(theta) with density (1 + k cos) / 2 on [-1, 1] from u uniform on [0, 1),
+// |k| < 1: the root in [-1, 1] of (k/4) c^2 + c/2 + (1/2 - k/4 - u) = 0, in
+// the form that stays accurate as k goes to 0.
+inline float correlatedCos(float u, float k) {
+    float c0 = 0.5f - 0.25f * k - u;
+    float disc = 0.25f - k * c0;
+    float c = -2.f * c0 / (0.5f + std::sqrt(std::max(0.f, disc)));
+    return std::min(1.f, std::max(-1.f, c));
+}
+
+// Turns the back-to-back toy into a three-body decay such as n -> p e- anti-nu:
+// the charged lepton's energy from the channel's beta spectrum, the neutrino
+// at the correlated opening angle theta from it (on either side, chosen by
+// uSide) with the rest of Q, and the daughter taking up the momentum of both.
+// The event is kept in the view's plane, so momentum balances exactly there.
+// A captured electron has no energy and the neutrino takes all of Q. Leaves
+// the mode rules to applyMode().
+//
+// The parent spin is along +-y, so the beta asymmetry only decides which
+// side of the x axis the lepton leaves on. The emission cone is symmetric
+// about x, so putting it at +-a on the side of the spin with probability
+// (1 + A beta |sin a|) / 2, from uTilt, gives exactly that density.
+inline DecaySample applyThreeBody(DecaySample s, float uEnergy, float uCos, float uSide, float uTilt) {
+    const DecayChannels& ch = decayChannels();
+    const std::size_t id = s.channel;
+    const BetaSpectrum* spectrum = ch.spectrum[id];
+    float t = spectrum ? spectrum->sample(uEnergy) : 0.f;
+    float beta = electronBeta(t);
+
+    float k = ch.asymmetryA[id] * beta * std::abs(s.dirE.y);
+    int side = uTilt < 0.5f * (1.f + k) ? s.neutronSpinSign : -s.neutronSpinSign;
+    if (signf(s.dirE.y) != side) {
+        s.dirE.y = -s.dirE.y;
+        s.spinE.y = -s.spinE.y;
+    }
+
+    float c = correlatedCos(uCos, ch.correlationA[id] * beta);
+    float sn = std::sqrt(std::max(0.f, 1.f - c * c)) * (uSide < 0.5f ? 1.f : -1.f);
+
+    s.dirNu = vnorm(sf::Vector2f(c * s.dirE.x - sn * s.dirE.y, sn * s.dirE.x + c * s.dirE.y));
+    s.spinNu = vnorm(s.dirNu * ch.neutralHelicity[id]);
+
+    float pE = std::sqrt(t * (t + 2.f * kElectronMass));
+    float pNu = ch.q[id] - t;
+    s.recoil = -(s.dirE * pE + s.dirNu * pNu);
+    s.electronT = spectrum ? t : -1.f;
+    return s;
+}
+
+// Screen speed of light. The antineutrino always moves at it and the
+// electron at beta times it, with a floor so slow electrons still get clear
+// of the nucleus. Decays without an energy move at kReferenceSpeed, and a
+// captured electron stays at the nucleus.
+constexpr float kLightSpeedPx = 320.f;
+constexpr float kMinElectronSpeedPx = 30.f;
+constexpr float kReferenceSpeedPx = 260.f;
+
+// Screen pixels per second for each MeV/c of proton recoil. The real recoil
+// is about 1e-3 c; this only makes its direction and size visible.
+constexpr float kRecoilPxPerMeV = 40.f;
+
+// sampleDecay() followed by four more draws (energy, opening angle, side,
+// tilt), so the first draws of every event match the two-body stream.
+inline DecaySample sampleThreeBody(std::mt19937& rng, float leftHandBias, Mode mode, float angleSpread = kAngleSpread,
+                                   float polarization = 1.f, std::uint8_t channel = 0) {
+    std::uniform_real_distribution<float> u01(0.f, 1.f);
+    DecaySample s = sampleDecay(rng, leftHandBias, mode, angleSpread, polarization, channel);
+    float uEnergy = u01(rng);
+    float uCos = u01(rng);
+    float uSide = u01(rng);
+    float uTilt = u01(rng);
+    return applyMode(applyThreeBody(s, uEnergy, uCos, uSide, uTilt), mode);
+}
+
+// Expand a sample into a renderable event starting at origin.
+inline DecayEvent eventFromSample(const DecaySample& s, sf::Vector2f origin) {
+    const DecayChannels& ch = decayChannels();
+    const std::size_t id = s.channel;
+    DecayEvent ev;
+    ev.channel = s.channel;
+    ev.neutronSpinSign = s.neutronSpinSign;
+    ev.electronT = s.electronT;
+
+    float speedE = kReferenceSpeedPx, speedNu = kReferenceSpeedPx;
+    if (ch.chargedSide[id] > 0) {
+        speedE = 0.f;
+        speedNu = kLightSpeedPx;
+    } else if (s.electronT >= 0.f) {
+        speedE = std::max(kMinElectronSpeedPx, kLightSpeedPx * electronBeta(s.electronT));
+        speedNu = kLightSpeedPx;
+    }
+
+    ev.electron.name = ch.chargedName[id];
+    ev.electron.pos = origin;
+    ev.electron.vel = s.dirE * speedE;
+    ev.electron.spinDir = s.spinE;
+    ev.electron.radius = 8.f;
+    ev.electron.color = ch.chargedColor[id];
+
+    ev.antinu.name = ch.neutralName[id];
+    ev.antinu.pos = origin;
+    ev.antinu.vel = s.dirNu * speedNu;
+    ev.antinu.spinDir = s.spinNu;
+    ev.antinu.radius = 6.f;
+    ev.antinu.color = ch.neutralColor[id];
+
+    ev.protonPos = origin + sf::Vector2f(40.f, 0.f);
+    ev.protonVel = s.recoil * kRecoilPxPerMeV;
+
+    ev.protonSpinSign = s.protonSpinSign;
+    ev.L_needed = s.L_needed;
+
+    return ev;
+}
+
+inline DecayEvent makeEvent(std::mt19937& rng, sf::Vector2f origin, float leftHandBias, Mode mode,
+                            float polarization = 1.f, std::uint8_t channel = 0) {
+    return eventFromSample(sampleThreeBody(rng, leftHandBias, mode, kAngleSpread, polarization, channel), origin);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+// Frame-budget level-of-detail control. Each frame reports how long it took
+// from one display to the next and how much of that was our own work (update
+// and draw submission); the governor keeps smoothed averages of both and
+// steps a detail level between 0 (everything) and levels - 1 (least):
+//
+//   - one level less as soon as frames miss the budget (vsync missed, or the
+//     work alone takes most of it),
+//   - one level more only after the work has stayed well under budget for a
+//     while. A level that was raised to and had to be dropped again within a
+//     second waits twice as long before it is tried again (up to half a
+//     minute), so a scene that sits at the edge does not flicker between two
+//     levels.
+//
+// Only drawing depends on the level; the simulation never sees it, so
+// recorded sessions replay identically whatever the level did.
+
+#include <algorithm>
+
+class DetailGovernor {
+public:
+    explicit DetailGovernor(int levels, double budgetSeconds = 1.0 / 60.0) : levels_(levels), budget_(budgetSeconds) {}
+
+    // Fixed level from now on; -1 goes back to automatic.
+    void pin(int level) {
+        pinned_ = level < 0 ? -1 : std::min(level, levels_ - 1);
+        if (pinned_ >= 0) level_ = pinned_;
+        sinceChange_ = 0;
+    }
+
+    bool automatic() const { return pinned_ < 0; }
+    int level() const { return level_; }
+    double budget() const { return budget_; }
+    double workSeconds() const { return work_; }
+    double frameSeconds() const { return interval_; }
+
+    // Starts over from full detail, e.g. when the load changes by a lot.
+    void reset() {
+        if (automatic()) level_ = 0;
+        work_ = interval_ = 0.0;
+        frames_ = sinceChange_ = 0;
+        raiseWait_ = kRaiseWait;
+        raised_ = false;
+    }
+
+    void frame(double frameSeconds, double workSeconds) {
+        work_ = frames_ ? work_ + kSmoothing * (workSeconds - work_) : workSeconds;
+        interval_ = frames_ ? interval_ + kSmoothing * (frameSeconds - interval_) : frameSeconds;
+        ++frames_;
+        ++sinceChange_;
+        if (!automatic()) return;
+
+        const bool over = interval_ > kMissed * budget_ || work_ > kHigh * budget_;
+        const bool light = interval_ < kMissed * budget_ && work_ < kLow * budget_;
+
+        if (over && sinceChange_ >= kSettle && level_ + 1 < levels_) {
+            // The last raise did not fit: back off before trying it again.
+            if (raised_ && sinceChange_ < kRaiseTrial) raiseWait_ = std::min(2 * raiseWait_, kMaxRaiseWait);
+            ++level_;
+            sinceChange_ = 0;
+            raised_ = false;
+        } else if (light && sinceChange_ >= raiseWait_ && level_ > 0) {
+            --level_;
+            sinceChange_ = 0;
+            raised_ = true;
+        } else if (raised_ && sinceChange_ >= kRaiseTrial) {
+            raiseWait_ = kRaiseWait;
+            raised_ = false;
+        }
+    }
+
+private:
+    // Frames, at the 60 Hz the budget is meant for.
+    static constexpr int kSettle = 12;         // averages catch up with a level change first
+    static constexpr int kRaiseWait = 90;      // light frames needed before adding detail
+    static constexpr int kRaiseTrial = 60;     // a raise that lasts this long fits
+    static constexpr int kMaxRaiseWait = 1920;
+    static constexpr double kSmoothing = 0.1;
+    static constexpr double kMissed = 1.25; // interval past this share of the budget: vsync was missed
+    static constexpr double kHigh = 0.8;    // work share that counts as over budget
+    static constexpr double kLow = 0.4;     // work share with room for more detail
+
+    int levels_;
+    double budget_;
+    int pinned_ = -1;
+    int level_ = 0;
+    double work_ = 0.0, interval_ = 0.0;
+    long frames_ = 0;
+    int sinceChange_ = 0;
+    int raiseWait_ = kRaiseWait;
+    bool raised_ = false;
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+// Binary event logs: a fixed header followed by fixed-size records, so decay N
+// lives at a known offset and can be read straight out of a memory mapping.
+// Files are written in native byte order (little-endian on every target we build).
+//
+// The header carries the writer's channel table as ChannelKeys, and each
+// record's channel id indexes that table. A reader maps the ids onto its own
+// table and refuses a log naming a channel it has not loaded.
+
+#include "decay_sim.hpp"
+#include "mapped_file.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+struct EventLogHeader {
+    char magic[8] = {'B', 'D', 'E', 'V', 'L', 'O', 'G', '\0'};
+    std::uint32_t version = 3;
+    std::uint32_t recordSize = 0;
+    std::uint64_t seed = 0;
+    float leftHandBias = 0.f;
+    std::uint32_t channelCount = 0; // entries used in channels
+    ChannelKey channels[DecayChannels::kMax] = {};
+};
+
+struct EventRecord {
+    float dirE[2];
+    float spinE[2];
+    float dirNu[2];
+    float spinNu[2];
+    float electronT; // MeV, < 0 for two-body decays
+    float recoil[2]; // proton momentum in MeV/c, zero for two-body decays
+    std::int8_t protonSpinSign;
+    std::int8_t neutronSpinSign;
+    std::int8_t L_needed;
+    std::uint8_t mode; // low nibble the mode (1..3), high nibble the index into the header's channels
+};
+
+static_assert(sizeof(EventLogHeader) == 160, "event log header layout changed");
+static_assert(sizeof(EventRecord) == 48, "event record layout changed");
+static_assert(std::is_trivially_copyable<EventRecord>::value, "records are read in place");
+
+inline EventRecord recordFromSample(const DecaySample& s, Mode mode) {
+    EventRecord r{};
+    r.dirE[0] = s.dirE.x;
+    r.dirE[1] = s.dirE.y;
+    r.spinE[0] = s.spinE.x;
+    r.spinE[1] = s.spinE.y;
+    r.dirNu[0] = s.dirNu.x;
+    r.dirNu[1] = s.dirNu.y;
+    r.spinNu[0] = s.spinNu.x;
+    r.spinNu[1] = s.spinNu.y;
+    r.electronT = s.electronT;
+    r.recoil[0] = s.recoil.x;
+    r.recoil[1] = s.recoil.y;
+    r.protonSpinSign = static_cast<std::int8_t>(s.protonSpinSign);
+    r.neutronSpinSign = static_cast<std::int8_t>(s.neutronSpinSign);
+    r.L_needed = static_cast<std::int8_t>(s.L_needed);
+    r.mode = static_cast<std::uint8_t>(static_cast<unsigned>(mode) | (static_cast<unsigned>(s.channel) << 4));
+    return r;
+}
+
+// channel is this run's id for the record's channel (MappedEventLog::channel()).
+inline DecaySample sampleFromRecord(const EventRecord& r, std::uint8_t channel) {
+    DecaySample s;
+    s.dirE = {r.dirE[0], r.dirE[1]};
+    s.spinE = {r.spinE[0], r.spinE[1]};
+    s.dirNu = {r.dirNu[0], r.dirNu[1]};
+    s.spinNu = {r.spinNu[0], r.spinNu[1]};
+    s.electronT = r.electronT;
+    s.recoil = {r.recoil[0], r.recoil[1]};
+    s.protonSpinSign = r.protonSpinSign;
+    s.neutronSpinSign = r.neutronSpinSign;
+    s.L_needed = r.L_needed;
+    s.channel = channel;
+    return s;
+}
+
+inline Mode modeFromRecord(const EventRecord& r) {
+    const unsigned m = r.mode & 0x0fu;
+    if (m == 2) return Mode::SpinAndMotion;
+    if (m == 3) return Mode::FullConservation;
+    return Mode::SpinOnly;
+}
+
+class EventLogWriter {
+public:
+    bool open(const std::string& path, std::uint64_t seed, float leftHandBias) {
+        out_.open(path, std::ios::binary | std::ios::trunc);
+        if (!out_) return false;
+        EventLogHeader h;
+        h.recordSize = sizeof(EventRecord);
+        h.seed = seed;
+        h.leftHandBias = leftHandBias;
+        const DecayChannels& table = decayChannels();
+        h.channelCount = static_cast<std::uint32_t>(table.count);
+        for (int i = 0; i < table.count; ++i) h.channels[i] = table.identity[static_cast<std::size_t>(i)];
+        out_.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        return static_cast<bool>(out_);
+    }
+
+    void append(const EventRecord& r) { out_.write(reinterpret_cast<const char*>(&r), sizeof(r)); }
+
+    bool close() {
+        out_.close();
+        return !out_.fail();
+    }
+
+private:
+    std::ofstream out_;
+};
+
+// Read-only view of an event log. Nothing is copied: record(i) points into the
+// mapping and the OS pages data in on demand, so the file size does not matter.
+class MappedEventLog {
+public:
+    bool open(const std::string& path) {
+        close();
+        error_.clear();
+        // Replay jumps around; don't waste I/O on readahead.
+        if (!file_.open(path, true)) return fail(file_.error());
+
+        if (file_.size() < sizeof(EventLogHeader)) return fail("file too small to be an event log");
+        std::memcpy(static_cast<void*>(&header_), file_.data(), sizeof(EventLogHeader));
+        if (std::memcmp(header_.magic, EventLogHeader{}.magic, sizeof(header_.magic)) != 0) return fail("not an event log");
+        if (header_.version != EventLogHeader{}.version || header_.recordSize != sizeof(EventRecord)) {
+            return fail("unsupported event log version; record it again");
+        }
+
+        // Ids past the table are never written, so only a damaged file shows
+        // channel 0 for them.
+        channelMap_.fill(0);
+        if (header_.channelCount == 0 || header_.channelCount > DecayChannels::kMax) return fail("bad channel table");
+        for (std::uint32_t i = 0; i < header_.channelCount; ++i) {
+            int id = findChannel(header_.channels[i]);
+            if (id < 0) {
+                return fail("needs channel " + channelKeyName(header_.channels[i]) +
+                            ", which this run does not have (add the isotope with --nuclide)");
+            }
+            channelMap_[i] = static_cast<std::uint8_t>(id);
+        }
+
+        records_ = reinterpret_cast<const EventRecord*>(file_.data() + sizeof(EventLogHeader));
+        count_ = (file_.size() - sizeof(EventLogHeader)) / sizeof(EventRecord);
+        return true;
+    }
+
+    void close() {
+        file_.close();
+        records_ = nullptr;
+        count_ = 0;
+    }
+
+    bool isOpen() const { return records_ != nullptr; }
+    std::uint64_t count() const { return count_; }
+    const EventRecord& record(std::uint64_t i) const { return records_[i]; }
+    // This run's channel id for a record of this log.
+    std::uint8_t channel(const EventRecord& r) const { return channelMap_[r.mode >> 4]; }
+    const EventLogHeader& header() const { return header_; }
+    const std::string& error() const { return error_; }
+
+private:
+    bool fail(const std::string& why) {
+        close();
+        error_ = why;
+        return false;
+    }
+
+    MappedFile file_;
+    const EventRecord* records_ = nullptr;
+    std::uint64_t count_ = 0;
+    EventLogHeader header_{};
+    std::array<std::uint8_t, DecayChannels::kMax> channelMap_{}; // record channel nibble -> this run's id
+    std::string error_;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+// Writes a sequence of frames to numbered image files on background threads.
+// The render thread only copies the pixels into a queue; encoders take frames
+// from it in any order and write DIR/frame_00000.png (or .ppm), so a slow PNG
+// encoder never stalls drawing. The queue is bounded: when every encoder is
+// busy and the queue is full, submit() waits, which keeps memory flat and
+// never drops a frame.
+
+#include "trace.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+enum class FrameFormat { Png, Ppm };
+
+inline const char* frameFormatExt(FrameFormat f) { return f == FrameFormat::Ppm ? "ppm" : "png"; }
+
+inline bool parseFrameFormat(const std::string& name, FrameFormat& out) {
+    if (name == "png") out = FrameFormat::Png;
+    else if (name == "ppm") out = FrameFormat::Ppm;
+    else return false;
+    return true;
+}
+
+// Binary PPM (P6) from RGBA pixels, alpha dropped. Much cheaper to write than
+// PNG at the cost of about 2.3 MB per 1100x700 frame.
+inline bool writePpm(const std::string& path, sf::Vector2u size, const std::uint8_t* rgba) {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    std::fprintf(f, "P6\n%u %u\n255\n", size.x, size.y);
+    std::vector<std::uint8_t> row(static_cast<std::size_t>(size.x) * 3);
+    bool ok = true;
+    for (unsigned y = 0; y < size.y && ok; ++y) {
+        const std::uint8_t* src = rgba + static_cast<std::size_t>(y) * size.x * 4;
+        for (unsigned x = 0; x < size.x; ++x) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        ok = std::fwrite(row.data(), 1, row.size(), f) == row.size();
+    }
+    return std::fclose(f) == 0 && ok;
+}
+
+class FrameExporter {
+public:
+    // threads = 0 picks hardware_concurrency() - 1 (at least 1), leaving a core for drawing.
+    FrameExporter(std::string dir, FrameFormat format, unsigned threads = 0) : dir_(std::move(dir)), format_(format) {
+        if (threads == 0) {
+            unsigned hw = std::thread::hardware_concurrency();
+            threads = hw > 1 ? hw - 1 : 1;
+        }
+        maxQueued_ = 2 * static_cast<std::size_t>(threads);
+        for (unsigned i = 0; i < threads; ++i) workers_.emplace_back([this, i] { run(i); });
+    }
+    FrameExporter(const FrameExporter&) = delete;
+    FrameExporter& operator=(const FrameExporter&) = delete;
+    ~FrameExporter() { finish(); }
+
+    // Queues a copy of the frame as the next number in the sequence.
+    void submit(sf::Vector2u size, const std::uint8_t* rgba) {
+        std::unique_lock<std::mutex> lock(m_);
+        notFull_.wait(lock, [this] { return queue_.size() < maxQueued_; });
+
+        Job job;
+        job.index = next_++;
+        job.size = size;
+        if (!spare_.empty()) {
+            job.px = std::move(spare_.back());
+            spare_.pop_back();
+        }
+        job.px.assign(rgba, rgba + static_cast<std::size_t>(size.x) * size.y * 4);
+        queue_.push_back(std::move(job));
+        notEmpty_.notify_one();
+    }
+
+    // Waits for every queued frame to be written. False if any write failed.
+    bool finish() {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            closing_ = true;
+        }
+        notEmpty_.notify_all();
+        for (auto& w : workers_) {
+            if (w.joinable()) w.join();
+        }
+        return failed_.load() == 0;
+    }
+
+    std::uint64_t submitted() const {
+        std::lock_guard<std::mutex> lock(m_);
+        return next_;
+    }
+    std::uint64_t failed() const { return failed_.load(); }
+
+    std::string pathFor(std::uint64_t index) const {
+        std::ostringstream name;
+        name << dir_ << "/frame_" << std::setw(5) << std::setfill('0') << index << "." << frameFormatExt(format_);
+        return name.str();
+    }
+
+private:
+    struct Job {
+        std::uint64_t index = 0;
+        sf::Vector2u size;
+        std::vector<std::uint8_t> px;
+    };
+
+    void run(unsigned worker) {
+        traceThreadName("encoder " + std::to_string(worker));
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_);
+                notEmpty_.wait(lock, [this] { return closing_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+                job = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            notFull_.notify_one();
+
+            TraceScope span("encode frame", static_cast<std::int64_t>(job.index));
+            std::string path = pathFor(job.index);
+            bool ok = format_ == FrameFormat::Ppm ? writePpm(path, job.size, job.px.data())
+                                                  : sf::Image(job.size, job.px.data()).saveToFile(path);
+            if (!ok) failed_.fetch_add(1);
+
+            // Hand the buffer back so steady-state recording does not allocate.
+            std::lock_guard<std::mutex> lock(m_);
+            spare_.push_back(std::move(job.px));
+        }
+    }
+
+    std::string dir_;
+    FrameFormat format_;
+    std::size_t maxQueued_ = 2;
+
+    mutable std::mutex m_;
+    std::condition_variable notEmpty_, notFull_;
+    std::deque<Job> queue_;
+    std::vector<std::vector<std::uint8_t>> spare_;
+    std::uint64_t next_ = 0;
+    bool closing_ = false;
+
+    std::atomic<std::uint64_t> failed_{0};
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+// Outcome histograms for the batch engine. Every worker fills its own
+// DecayHistograms with plain increments and the results are combined with
+// merge(), so no counter is ever shared between threads while sampling.
+
+#include "decay_sim.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Keep per-worker state on separate cache lines.
+constexpr std::size_t kCacheLine = 64;
+
+// Same test the HUD applies to the current event.
+inline bool claimLooksTrue(float spinDot) { return spinDot < -0.2f; }
+
+inline float sampleSpinDot(const DecaySample& s) { return vdot(vnorm(s.spinE), vnorm(s.spinNu)); }
+
+struct DecayHistograms {
+    // L_needed = neutron - (proton + electron + antinu) with every term +-1,
+    // so it lies in [-2, 4] (in [-4, 4] with electron capture, where the
+    // electron counts with the neutron). Nuclei count 2J each, and with 2J
+    // at most kMaxTwoJ (nuclide_db.hpp) |L_needed| stays within 2 * 30 + 2.
+    // The end bins would take anything beyond.
+    static constexpr int kLMin = -64;
+    static constexpr int kLBins = 129;
+    static constexpr int kSpinDotBins = 20; // over [-1, 1]
+
+    std::uint64_t events = 0;
+    std::uint64_t claimTrue = 0;
+    std::array<std::uint64_t, kLBins> lNeeded{};
+    std::array<std::uint64_t, kSpinDotBins> spinDot{};
+    std::array<std::uint64_t, 4> helicity{}; // [hE > 0][hN > 0]
+    std::array<std::uint64_t, 4> emission{}; // [neutron spin up][electron dirE.y >= 0]
+    std::array<std::uint64_t, DecayChannels::kMax> channel{};
+
+    static int spinDotBin(float d) {
+        int b = static_cast<int>((d + 1.f) * 0.5f * kSpinDotBins);
+        return b < 0 ? 0 : (b >= kSpinDotBins ? kSpinDotBins - 1 : b);
+    }
+    static float spinDotBinCenter(int b) { return -1.f + (b + 0.5f) * (2.f / kSpinDotBins); }
+    static int helicityIndex(int hE, int hN) { return (hE > 0 ? 2 : 0) + (hN > 0 ? 1 : 0); }
+    static int emissionIndex(int neutronSign, int electronSign) { return (neutronSign > 0 ? 2 : 0) + (electronSign > 0 ? 1 : 0); }
+
+    void add(const DecaySample& s) {
+        float d = sampleSpinDot(s);
+        int hE = helicitySign(vnorm(s.spinE), s.dirE);
+        int hN = helicitySign(vnorm(s.spinNu), s.dirNu);
+        int l = std::min(std::max(s.L_needed - kLMin, 0), kLBins - 1);
+
+        ++events;
+        claimTrue += claimLooksTrue(d) ? 1u : 0u;
+        ++lNeeded[static_cast<std::size_t>(l)];
+        ++spinDot[static_cast<std::size_t>(spinDotBin(d))];
+        ++helicity[static_cast<std::size_t>(helicityIndex(hE, hN))];
+        ++emission[static_cast<std::size_t>(emissionIndex(s.neutronSpinSign, signf(s.dirE.y)))];
+        ++channel[s.channel];
+    }
+
+    DecayHistograms& merge(const DecayHistograms& o) {
+        events += o.events;
+        claimTrue += o.claimTrue;
+        for (std::size_t i = 0; i < lNeeded.size(); ++i) lNeeded[i] += o.lNeeded[i];
+        for (std::size_t i = 0; i < spinDot.size(); ++i) spinDot[i] += o.spinDot[i];
+        for (std::size_t i = 0; i < helicity.size(); ++i) helicity[i] += o.helicity[i];
+        for (std::size_t i = 0; i < emission.size(); ++i) emission[i] += o.emission[i];
+        for (std::size_t i = 0; i < channel.size(); ++i) channel[i] += o.channel[i];
+        return *this;
+    }
+
+    std::uint64_t lNeededCount(int L) const {
+        int i = L - kLMin;
+        return (i >= 0 && i < kLBins) ? lNeeded[static_cast<std::size_t>(i)] : 0;
+    }
+    // Range of L worth showing: [-4, 4] widened to every bin with counts.
+    void lShown(int& lo, int& hi) const {
+        lo = -4;
+        hi = 4;
+        for (int i = 0; i < kLBins; ++i) {
+            if (!lNeeded[static_cast<std::size_t>(i)]) continue;
+            lo = std::min(lo, i + kLMin);
+            hi = std::max(hi, i + kLMin);
+        }
+    }
+    std::uint64_t helicityCount(int hE, int hN) const {
+        return helicity[static_cast<std::size_t>(helicityIndex(hE, hN))];
+    }
+    std::uint64_t emissionCount(int neutronSign, int electronSign) const {
+        return emission[static_cast<std::size_t>(emissionIndex(neutronSign, electronSign))];
+    }
+    std::uint64_t neutronUp() const { return emissionCount(+1, -1) + emissionCount(+1, +1); }
+    std::uint64_t electronUp() const { return emissionCount(-1, +1) + emissionCount(+1, +1); }
+    // Electrons on the side the neutron spin points to.
+    std::uint64_t electronWithSpin() const { return emissionCount(-1, -1) + emissionCount(+1, +1); }
+    double claimFraction() const { return events ? static_cast<double>(claimTrue) / static_cast<double>(events) : 0.0; }
+    double meanAbsL() const {
+        if (!events) return 0.0;
+        std::uint64_t sum = 0;
+        for (int i = 0; i < kLBins; ++i) {
+            int L = i + kLMin;
+            sum += static_cast<std::uint64_t>(L < 0 ? -L : L) * lNeeded[static_cast<std::size_t>(i)];
+        }
+        return static_cast<double>(sum) / static_cast<double>(events);
+    }
+};
+
+// (N+ - N-) / N for k of n events counted as +, with its standard error.
+struct Asymmetry {
+    double value = 0.0;
+    double err = 0.0;
+};
+
+inline Asymmetry countAsymmetry(std::uint64_t k, std::uint64_t n) {
+    Asymmetry a;
+    if (n == 0) return a;
+    double nn = static_cast<double>(n);
+    a.value = 2.0 * static_cast<double>(k) / nn - 1.0;
+    a.err = std::sqrt(std::max(0.0, 1.0 - a.value * a.value) / nn);
+    return a;
+}
+
+inline double absLVariance(const DecayHistograms& h) {
+    if (h.events < 2) return 0.0;
+    double mean = h.meanAbsL(), m2 = 0.0;
+    for (int i = 0; i < DecayHistograms::kLBins; ++i) {
+        double d = std::abs(i + DecayHistograms::kLMin) - mean;
+        m2 += d * d * static_cast<double>(h.lNeeded[static_cast<std::size_t>(i)]);
+    }
+    return m2 / static_cast<double>(h.events - 1);
+}
+
+// A worker's last published copy, readable by a checkpointing thread without
+// locks. Only the owning worker stores (relaxed store of its own running
+// totals), so publishing is plain writes and no atomic read-modify-write.
+// A snapshot can mix counters from two consecutive publications; that is fine
+// for progress reports, and final results come from the workers' own copies.
+struct alignas(kCacheLine) PublishedHistograms {
+    std::atomic<std::uint64_t> events{0};
+    std::atomic<std::uint64_t> claimTrue{0};
+    std::array<std::atomic<std::uint64_t>, DecayHistograms::kLBins> lNeeded{};
+    std::array<std::atomic<std::uint64_t>, DecayHistograms::kSpinDotBins> spinDot{};
+    std::array<std::atomic<std::uint64_t>, 4> helicity{};
+    std::array<std::atomic<std::uint64_t>, 4> emission{};
+    std::array<std::atomic<std::uint64_t>, DecayChannels::kMax> channel{};
+
+    void publish(const DecayHistograms& h) {
+        auto st = [](std::atomic<std::uint64_t>& a, std::uint64_t v) { a.store(v, std::memory_order_relaxed); };
+        for (std::size_t i = 0; i < lNeeded.size(); ++i) st(lNeeded[i], h.lNeeded[i]);
+        for (std::size_t i = 0; i < spinDot.size(); ++i) st(spinDot[i], h.spinDot[i]);
+        for (std::size_t i = 0; i < helicity.size(); ++i) st(helicity[i], h.helicity[i]);
+        for (std::size_t i = 0; i < emission.size(); ++i) st(emission[i], h.emission[i]);
+        for (std::size_t i = 0; i < channel.size(); ++i) st(channel[i], h.channel[i]);
+        st(claimTrue, h.claimTrue);
+        events.store(h.events, std::memory_order_release);
+    }
+
+    void mergeInto(DecayHistograms& out) const {
+        auto ld = [](const std::atomic<std::uint64_t>& a) { return a.load(std::memory_order_relaxed); };
+        out.events += events.load(std::memory_order_acquire);
+        out.claimTrue += ld(claimTrue);
+        for (std::size_t i = 0; i < lNeeded.size(); ++i) out.lNeeded[i] += ld(lNeeded[i]);
+        for (std::size_t i = 0; i < spinDot.size(); ++i) out.spinDot[i] += ld(spinDot[i]);
+        for (std::size_t i = 0; i < helicity.size(); ++i) out.helicity[i] += ld(helicity[i]);
+        for (std::size_t i = 0; i < emission.size(); ++i) out.emission[i] += ld(emission[i]);
+        for (std::size_t i = 0; i < channel.size(); ++i) out.channel[i] += ld(channel[i]);
+    }
+};
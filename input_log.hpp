@@ -0,0 +1,185 @@
+#pragma once
+
+// Keyboard sessions for exact replays. A recording stores the seed, the
+// starting view and the run's channel table in its header, then one record
+// per frame with the frame time the simulation was stepped by, followed by a
+// record for each key handled in that frame. C steps through the channel
+// table, so a log only replays on a run with the same table. Feeding the same
+// frame times and keys back through the same code gives the same state frame
+// for frame. Same layout rules as event_log.hpp: fixed-size records in native
+// byte order.
+
+#include "decay_cloud.hpp"
+#include "decay_sim.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+struct InputLogHeader {
+    char magic[8] = {'B', 'D', 'I', 'N', 'P', 'U', 'T', '\0'};
+    std::uint32_t version = 1;
+    std::uint32_t recordSize = 0;
+    std::uint64_t seed = 0;
+    float leftHandBias = 0.f;
+    float polarization = 1.f;
+    std::uint8_t mode = 1;
+    std::uint8_t channel = 0; // starting decay channel, an index into channels
+    std::uint8_t tauLeap = 0; // 1 if --tau-leap was given
+    std::uint8_t reserved = 0;
+    std::uint32_t cloud = 0;      // decays in the starting cloud view, 0 for the single view
+    std::uint64_t population = 0; // neutrons in population mode, 0 when off
+    float lifetime = 10.f;        // their mean lifetime, seconds
+    std::uint32_t channelCount = 0;
+    ChannelKey channels[DecayChannels::kMax] = {}; // the recording run's channel table
+};
+
+struct InputRecord {
+    enum Kind : std::uint8_t { Frame = 0, Key = 1 };
+
+    std::uint32_t frame;
+    float value;      // Frame: seconds the frame was stepped by. Key: session time in seconds.
+    std::int16_t key; // sf::Keyboard::Key for Key records
+    std::uint8_t kind;
+    std::uint8_t reserved;
+};
+
+static_assert(sizeof(InputLogHeader) == 184, "input log header layout changed");
+static_assert(sizeof(InputRecord) == 12, "input record layout changed");
+static_assert(std::is_trivially_copyable<InputRecord>::value, "records are written as bytes");
+
+class InputLogWriter {
+public:
+    // start holds the session's starting state; magic, version, record size
+    // and the channel table are filled in here.
+    bool open(const std::string& path, InputLogHeader start) {
+        out_.open(path, std::ios::binary | std::ios::trunc);
+        if (!out_) return false;
+        const InputLogHeader h = withLayout(start);
+        out_.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        return static_cast<bool>(out_);
+    }
+
+    bool isOpen() const { return out_.is_open(); }
+
+    void frame(std::uint32_t index, float dt) {
+        time_ += dt;
+        append(InputRecord{index, dt, 0, InputRecord::Frame, 0});
+    }
+
+    void key(std::uint32_t index, sf::Keyboard::Key code) {
+        append(InputRecord{index, time_, static_cast<std::int16_t>(code), InputRecord::Key, 0});
+    }
+
+    bool close() {
+        out_.close();
+        return !out_.fail();
+    }
+
+private:
+    static InputLogHeader withLayout(InputLogHeader h) {
+        const InputLogHeader layout;
+        std::memcpy(h.magic, layout.magic, sizeof(h.magic));
+        h.version = layout.version;
+        h.recordSize = sizeof(InputRecord);
+        const DecayChannels& table = decayChannels();
+        h.channelCount = static_cast<std::uint32_t>(table.count);
+        for (int i = 0; i < table.count; ++i) h.channels[i] = table.identity[static_cast<std::size_t>(i)];
+        return h;
+    }
+
+    void append(const InputRecord& r) { out_.write(reinterpret_cast<const char*>(&r), sizeof(r)); }
+
+    std::ofstream out_;
+    float time_ = 0.f;
+};
+
+// A whole recording in memory (a few hundred kB for a long session), read
+// back frame by frame: nextFrame() gives the frame time, then nextKey()
+// yields that frame's keys in the order they were handled.
+class InputLog {
+public:
+    bool load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return fail("cannot open");
+        if (!in.read(reinterpret_cast<char*>(&header_), sizeof(header_))) return fail("too short for an input log header");
+        if (std::memcmp(header_.magic, InputLogHeader{}.magic, sizeof(header_.magic)) != 0) return fail("not an input log");
+        if (header_.version != InputLogHeader{}.version || header_.recordSize != sizeof(InputRecord)) {
+            return fail("unsupported input log version");
+        }
+        if (!sameChannels()) return false;
+        if (header_.channel >= decayChannels().count) return fail("unknown decay channel");
+        if (header_.cloud != 0 && (header_.cloud < DecayCloud::kMinSize || header_.cloud > DecayCloud::kMaxSize)) {
+            return fail("bad cloud size");
+        }
+        if (header_.population != 0 && (!(header_.lifetime > 0.f) || header_.cloud != 0)) return fail("bad population");
+        if (header_.tauLeap > 1 || (header_.tauLeap && header_.population == 0)) return fail("bad population");
+
+        InputRecord r;
+        while (in.read(reinterpret_cast<char*>(&r), sizeof(r))) {
+            if (r.kind != InputRecord::Frame && r.kind != InputRecord::Key) return fail("corrupt record");
+            records_.push_back(r);
+            if (r.kind == InputRecord::Frame) ++frames_;
+        }
+        pos_ = 0;
+        return true;
+    }
+
+    const InputLogHeader& header() const { return header_; }
+    Mode mode() const {
+        if (header_.mode == 2) return Mode::SpinAndMotion;
+        if (header_.mode == 3) return Mode::FullConservation;
+        return Mode::SpinOnly;
+    }
+    std::uint64_t frames() const { return frames_; }
+    const std::string& error() const { return error_; }
+
+    // False once the recording is exhausted.
+    bool nextFrame(float& dt) {
+        while (pos_ < records_.size() && records_[pos_].kind != InputRecord::Frame) ++pos_;
+        if (pos_ >= records_.size()) return false;
+        dt = records_[pos_++].value;
+        return true;
+    }
+
+    bool nextKey(sf::Keyboard::Key& code) {
+        if (pos_ >= records_.size() || records_[pos_].kind != InputRecord::Key) return false;
+        code = static_cast<sf::Keyboard::Key>(records_[pos_++].key);
+        return true;
+    }
+
+private:
+    bool fail(const std::string& why) {
+        error_ = why;
+        return false;
+    }
+
+    // The recording's channel table must be this run's, row for row.
+    bool sameChannels() {
+        const DecayChannels& table = decayChannels();
+        if (header_.channelCount == 0 || header_.channelCount > DecayChannels::kMax) return fail("bad channel table");
+        for (std::uint32_t i = 0; i < header_.channelCount; ++i) {
+            if (findChannel(header_.channels[i]) < 0) {
+                return fail("needs channel " + channelKeyName(header_.channels[i]) +
+                            ", which this run does not have (add the isotope with --nuclide)");
+            }
+        }
+        bool same = header_.channelCount == static_cast<std::uint32_t>(table.count);
+        for (std::uint32_t i = 0; same && i < header_.channelCount; ++i) {
+            same = header_.channels[i] == table.identity[i];
+        }
+        return same || fail("recorded with other channels or in another order; replay with the same --nuclide list");
+    }
+
+    InputLogHeader header_;
+    std::vector<InputRecord> records_;
+    std::size_t pos_ = 0;
+    std::uint64_t frames_ = 0;
+    std::string error_;
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+// Background sampler for the statistics panel. A worker thread keeps calling
+// sampleDecay() with the mode, bias, polarization and channel the view is showing and hands running
+// totals to the render thread through a triple buffer, so neither side ever
+// waits on the other. Changing the parameters restarts the totals.
+
+#include "decay_sim.hpp"
+#include "histograms.hpp"
+#include "running_stat.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+// Single producer, single consumer. The writer fills writeBuffer() and
+// publish()es it; the reader calls update() and then reads read(). The three
+// slots rotate through one atomic index, so both sides are wait-free.
+template <class T>
+class TripleBuffer {
+public:
+    T& writeBuffer() { return buf_[back_]; }
+    void publish() { back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) & kIndex; }
+
+    bool update() {
+        if (!(middle_.load(std::memory_order_relaxed) & kFresh)) return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+    const T& read() const { return buf_[front_]; }
+
+private:
+    static constexpr int kIndex = 3;
+    static constexpr int kFresh = 4;
+
+    T buf_[3]{};
+    int back_ = 0;
+    alignas(kCacheLine) std::atomic<int> middle_{1};
+    alignas(kCacheLine) int front_ = 2;
+};
+
+struct LiveSnapshot {
+    Mode mode = Mode::SpinOnly;
+    float leftHandBias = 0.f;
+    float polarization = 1.f;
+    std::uint8_t channel = 0;
+    DecayHistograms hist;
+    RunningStat claim; // indicator of "claim looks true"
+};
+
+class LiveStats {
+public:
+    // Stop sampling once the estimate is this settled; resumes on a parameter change.
+    static constexpr std::uint64_t kMaxEvents = 50000000;
+    static constexpr int kChunk = 4096; // events between publications
+
+    explicit LiveStats(std::uint64_t seed) : seed_(seed) {}
+    LiveStats(const LiveStats&) = delete;
+    LiveStats& operator=(const LiveStats&) = delete;
+    ~LiveStats() { stop(); }
+
+    void start(Mode mode, float leftHandBias, float polarization = 1.f, std::uint8_t channel = 0) {
+        setParams(mode, leftHandBias, polarization, channel);
+        if (!worker_.joinable()) worker_ = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        quit_.store(true, std::memory_order_relaxed);
+        if (worker_.joinable()) worker_.join();
+    }
+
+    // Render thread, once per frame. Cheap when nothing changed.
+    void setParams(Mode mode, float leftHandBias, float polarization = 1.f, std::uint8_t channel = 0) {
+        if (mode == mode_ && leftHandBias == bias_ && polarization == polarization_ && channel == channel_) return;
+        mode_ = mode;
+        bias_ = leftHandBias;
+        polarization_ = polarization;
+        channel_ = channel;
+        modeShared_.store(static_cast<int>(mode), std::memory_order_relaxed);
+        biasShared_.store(leftHandBias, std::memory_order_relaxed);
+        polarizationShared_.store(polarization, std::memory_order_relaxed);
+        channelShared_.store(channel, std::memory_order_relaxed);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+
+    // Render thread: latest totals (possibly from a few ms ago).
+    const LiveSnapshot& latest() {
+        snapshots_.update();
+        return snapshots_.read();
+    }
+
+private:
+    void run() {
+        std::mt19937 rng = seededRng(seed_, 0x11fe);
+        std::uint64_t seen = ~std::uint64_t{0};
+        LiveSnapshot acc;
+
+        while (!quit_.load(std::memory_order_relaxed)) {
+            std::uint64_t gen = generation_.load(std::memory_order_acquire);
+            if (gen != seen) {
+                seen = gen;
+                acc = LiveSnapshot{};
+                acc.mode = static_cast<Mode>(modeShared_.load(std::memory_order_relaxed));
+                acc.leftHandBias = biasShared_.load(std::memory_order_relaxed);
+                acc.polarization = polarizationShared_.load(std::memory_order_relaxed);
+                acc.channel = channelShared_.load(std::memory_order_relaxed);
+            }
+
+            if (acc.hist.events >= kMaxEvents) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                continue;
+            }
+
+            for (int i = 0; i < kChunk; ++i) {
+                DecaySample s = sampleDecay(rng, acc.leftHandBias, acc.mode, kAngleSpread, acc.polarization,
+                                           acc.channel);
+                acc.hist.add(s);
+                acc.claim.add(claimLooksTrue(sampleSpinDot(s)) ? 1.0 : 0.0);
+            }
+
+            snapshots_.writeBuffer() = acc;
+            snapshots_.publish();
+            // Leave the core to the render thread on small machines.
+            std::this_thread::yield();
+        }
+    }
+
+    std::uint64_t seed_;
+    std::thread worker_;
+    std::atomic<bool> quit_{false};
+
+    // Render-thread copies, to skip redundant restarts.
+    Mode mode_ = Mode::SpinOnly;
+    float bias_ = -1.f;
+    float polarization_ = -1.f;
+    std::uint8_t channel_ = 0;
+
+    std::atomic<int> modeShared_{1};
+    std::atomic<float> biasShared_{0.f};
+    std::atomic<float> polarizationShared_{1.f};
+    std::atomic<std::uint8_t> channelShared_{0};
+    std::atomic<std::uint64_t> generation_{0};
+
+    TripleBuffer<LiveSnapshot> snapshots_;
+};
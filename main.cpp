@@ -1,56 +1,43 @@
+#include "batch.hpp"
+#include "correlation.hpp"
+#include "decay_cloud.hpp"
+#include "decay_sim.hpp"
+#include "detail_governor.hpp"
+#include "event_log.hpp"
+#include "frame_export.hpp"
+#include "input_log.hpp"
+#include "live_stats.hpp"
+#include "nuclide_db.hpp"
+#include "paired.hpp"
+#include "population.hpp"
+#include "render_backend.hpp"
+#include "render_stats.hpp"
+#include "soft_raster.hpp"
+#include "sweep.hpp"
+#include "trace.hpp"
+#include "ui_font.hpp"
+
 #include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <iomanip>
+#include <iostream>
 #include <optional>
 #include <random>
 #include <sstream>
 #include <string>
 #include <vector>
 
-static float vlen(sf::Vector2f v) { return std::sqrt(v.x * v.x + v.y * v.y); }
-static sf::Vector2f vnorm(sf::Vector2f v) {
-    float l = vlen(v);
-    if (l <= 1e-6f) return {0.f, 0.f};
-    return {v.x / l, v.y / l};
-}
-static float vdot(sf::Vector2f a, sf::Vector2f b) { return a.x * b.x + a.y * b.y; }
-static sf::Vector2f vperp(sf::Vector2f v) { return {-v.y, v.x}; }
-
-struct Particle {
-    std::string name;
-    sf::Vector2f pos;
-    sf::Vector2f vel;     // momentum direction is normalized vel
-    sf::Vector2f spinDir; // spin direction unit vector
-    float radius = 8.f;
-    sf::Color color = sf::Color::White;
-
-    std::vector<sf::Vector2f> trail;
-    float trailTimer = 0.f;
-};
-
-struct DecayEvent {
-    Particle electron;
-    Particle antinu;
-    int protonSpinSign = 0; // toy +1 or -1
-    int neutronSpinSign = +1;
-    int L_needed = 0;       // toy orbital term
-    float timeAlive = 0.f;
-    float duration = 3.0f;
-};
-
-enum class Mode {
-    SpinOnly = 1,      // deliberately oversimplified: "spins always cancel"
-    SpinAndMotion = 2, // show momentum + helicity
-    FullConservation = 3 // show orbital placeholder L_needed
-};
+enum class TipId { Neutron, Proton, Electron, AntiNu, Momentum, Spin, Swirl, Count };
 
 struct Tooltip {
-    sf::Vector2f pos{};
-    std::string title;
-    std::string body;
+    TipId id = TipId::Neutron;
     bool active = false;
 };
 
@@ -64,7 +51,8 @@ static bool hitCircle(sf::Vector2f mouse, sf::Vector2f center, float r) {
     return dist2(mouse, center) <= (r * r);
 }
 
-static void drawLabel(sf::RenderTarget& rt, const sf::Font& font, sf::Vector2f at, const std::string& s) {
+static void drawLabel(RenderBackend& rt, const sf::Font& font, sf::Vector2f at, const std::string& s) {
+    DrawTag tag(rt, DrawHelper::Label);
     sf::Text t(font);
     t.setCharacterSize(14);
     t.setFillColor(sf::Color(245, 245, 245, 220));
@@ -75,47 +63,7 @@ static void drawLabel(sf::RenderTarget& rt, const sf::Font& font, sf::Vector2f a
     auto b = t.getLocalBounds();
     t.setOrigin(sf::Vector2f{b.position.x + b.size.x * 0.5f, b.position.y + b.size.y * 0.5f});
     t.setPosition(at);
-    rt.draw(t);
-}
-
-static void drawTooltipBox(sf::RenderTarget& rt, const sf::Font& font, sf::Vector2f mousePos, const std::string& title, const std::string& body) {
-    sf::Text tt(font);
-    tt.setCharacterSize(16);
-    tt.setFillColor(sf::Color(240, 240, 240));
-    tt.setString(title);
-
-    sf::Text tb(font);
-    tb.setCharacterSize(15);
-    tb.setFillColor(sf::Color(220, 220, 220));
-    tb.setString(body);
-
-    auto bt = tt.getLocalBounds();
-    auto bb = tb.getLocalBounds();
-
-    float pad = 10.f;
-    float w = std::max(bt.size.x, bb.size.x) + pad * 2.f;
-    float h = (bt.size.y + bb.size.y) + pad * 3.f;
-
-    sf::Vector2f boxPos = mousePos + sf::Vector2f{16.f, 16.f};
-
-    // Keep inside window-ish bounds (simple clamp)
-    if (boxPos.x + w > 1080.f) boxPos.x = 1080.f - w;
-    if (boxPos.y + h > 680.f) boxPos.y = 680.f - h;
-    if (boxPos.x < 10.f) boxPos.x = 10.f;
-    if (boxPos.y < 10.f) boxPos.y = 10.f;
-
-    sf::RectangleShape r(sf::Vector2f{w, h});
-    r.setPosition(boxPos);
-    r.setFillColor(sf::Color(10, 12, 16, 230));
-    r.setOutlineThickness(1.f);
-    r.setOutlineColor(sf::Color(90, 100, 125, 200));
-    rt.draw(r);
-
-    tt.setPosition(boxPos + sf::Vector2f{pad, pad});
-    tb.setPosition(boxPos + sf::Vector2f{pad, pad * 2.f + bt.size.y});
-
-    rt.draw(tt);
-    rt.draw(tb);
+    rt.drawText(t);
 }
 
 static float pointSegmentDistance(sf::Vector2f p, sf::Vector2f a, sf::Vector2f b) {
@@ -129,21 +77,15 @@ static float pointSegmentDistance(sf::Vector2f p, sf::Vector2f a, sf::Vector2f b
 }
 
 
-static int signf(float x) { return (x >= 0.f) ? 1 : -1; }
-
-static int helicitySign(const sf::Vector2f& spinDir, const sf::Vector2f& momDir) {
-    // helicity sign is sign(spin dot momentum)
-    return signf(vdot(spinDir, momDir));
-}
-
-static void drawArrow(sf::RenderTarget& rt, sf::Vector2f from, sf::Vector2f dirUnit, float L, sf::Color col, float head = 10.f) {
+static void drawArrow(RenderBackend& rt, sf::Vector2f from, sf::Vector2f dirUnit, float L, sf::Color col, float head = 10.f) {
+    DrawTag tag(rt, DrawHelper::Arrow);
     sf::Vector2f to = from + dirUnit * L;
 
     sf::Vertex line[2] = {
         sf::Vertex{from, col},
         sf::Vertex{to, col},
     };
-    rt.draw(line, 2, sf::PrimitiveType::Lines);
+    rt.drawVertices(line, 2, sf::PrimitiveType::Lines);
 
     sf::Vector2f p = vperp(dirUnit);
     sf::Vector2f h1 = to - dirUnit * head + p * (head * 0.55f);
@@ -153,10 +95,11 @@ static void drawArrow(sf::RenderTarget& rt, sf::Vector2f from, sf::Vector2f dirU
         sf::Vertex{to, col}, sf::Vertex{h1, col},
         sf::Vertex{to, col}, sf::Vertex{h2, col},
     };
-    rt.draw(headLines, 4, sf::PrimitiveType::Lines);
+    rt.drawVertices(headLines, 4, sf::PrimitiveType::Lines);
 }
 
-static void drawGlowCircle(sf::RenderTarget& rt, sf::Vector2f center, float r, sf::Color c) {
+static void drawGlowCircle(RenderBackend& rt, sf::Vector2f center, float r, sf::Color c) {
+    DrawTag tag(rt, DrawHelper::Glow);
     for (int i = 5; i >= 1; --i) {
         float rr = r + i * 6.f;
         sf::CircleShape s(rr);
@@ -165,18 +108,19 @@ static void drawGlowCircle(sf::RenderTarget& rt, sf::Vector2f center, float r, s
         cc.a = static_cast<std::uint8_t>(18 * i);
         s.setFillColor(cc);
         s.setPosition(center);
-        rt.draw(s);
+        rt.drawShape(s);
     }
 
     sf::CircleShape core(r);
     core.setOrigin(sf::Vector2f{r, r});
     core.setFillColor(c);
     core.setPosition(center);
-    rt.draw(core);
+    rt.drawShape(core);
 }
 
-static void drawTrail(sf::RenderTarget& rt, const Particle& p) {
+static void drawTrail(RenderBackend& rt, const Particle& p) {
     if (p.trail.size() < 2) return;
+    DrawTag tag(rt, DrawHelper::Trail);
 
     sf::VertexArray va(sf::PrimitiveType::LineStrip, p.trail.size());
     for (std::size_t i = 0; i < p.trail.size(); ++i) {
@@ -189,9 +133,10 @@ static void drawTrail(sf::RenderTarget& rt, const Particle& p) {
     rt.draw(va);
 }
 
-static void drawOrbitalSwirl(sf::RenderTarget& rt, sf::Vector2f center, int L_needed, float time) {
+static void drawOrbitalSwirl(RenderBackend& rt, sf::Vector2f center, int L_needed, float time) {
     int mag = std::abs(L_needed);
     if (mag == 0) return;
+    DrawTag tag(rt, DrawHelper::Swirl);
 
     float baseR = 22.f;
     float r = baseR + mag * 10.f;
@@ -214,66 +159,239 @@ static void drawOrbitalSwirl(sf::RenderTarget& rt, sf::Vector2f center, int L_ne
     rt.draw(va);
 }
 
-static DecayEvent makeEvent(std::mt19937& rng, sf::Vector2f origin, float leftHandBias, Mode mode) {
-    std::uniform_real_distribution<float> u01(0.f, 1.f);
-    std::uniform_real_distribution<float> angleDist(-0.35f, 0.35f);
-    std::uniform_int_distribution<int> pm01(0, 1);
-
-    DecayEvent ev;
-    ev.neutronSpinSign = +1;
+static sf::RectangleShape hudPanel(sf::Vector2f pos, sf::Vector2f size) {
+    sf::RectangleShape r(size);
+    r.setPosition(pos);
+    r.setFillColor(sf::Color(10, 12, 16, 200));
+    r.setOutlineThickness(1.f);
+    r.setOutlineColor(sf::Color(80, 90, 110, 180));
+    return r;
+}
 
-    // Mostly rightward electron momentum
-    float a = angleDist(rng);
-    sf::Vector2f dirE(std::cos(a), std::sin(a));
-    dirE = vnorm(dirE);
-    sf::Vector2f dirNu = vnorm(-dirE);
+// Running totals from the background sampler: claim probability with its 95%
+// interval and the L_needed histogram as bars.
+static void drawStatsPanel(RenderBackend& rt, const sf::Font& font, sf::Vector2f pos, const LiveSnapshot& snap) {
+    DrawTag tag(rt, DrawHelper::StatsPanel);
+    const sf::Vector2f size{280.f, 300.f};
+    rt.drawShape(hudPanel(pos, size));
+
+    const DecayHistograms& h = snap.hist;
+    std::ostringstream ss;
+    ss << "Background sampling (S hides)\n";
+    ss << "mode " << static_cast<int>(snap.mode) << ", bias " << std::fixed << std::setprecision(2) << snap.leftHandBias
+       << ": " << h.events << " decays\n";
+    ss << "P(claim looks true) = " << std::setprecision(4) << snap.claim.mean << "\n";
+    ss << "  95% interval +- " << snap.claim.halfWidth(1.96) << "\n";
+    ss << "L_needed over all decays:";
+
+    sf::Text text(font);
+    text.setCharacterSize(15);
+    text.setFillColor(sf::Color(230, 230, 230));
+    text.setPosition(pos + sf::Vector2f{10.f, 8.f});
+    text.setString(ss.str());
+    rt.drawText(text);
+
+    // Bars, tallest bin scaled to maxH
+    const float baseY = pos.y + size.y - 30.f;
+    const float maxH = 140.f;
+    int lo = 0, hi = 0;
+    h.lShown(lo, hi);
+    const int shown = hi - lo + 1;
+    const float gap = (size.x - 20.f) / static_cast<float>(shown);
+    const float barW = std::min(22.f, gap - 2.f);
+    const int labelEvery = gap >= 18.f ? 1 : (gap >= 9.f ? 2 : 4); // keep axis labels from overlapping
+
+    std::uint64_t most = 1;
+    for (std::uint64_t n : h.lNeeded) most = std::max(most, n);
+
+    sf::VertexArray bars(sf::PrimitiveType::Triangles);
+    sf::Text label(font);
+    label.setCharacterSize(14);
+    label.setFillColor(sf::Color(200, 200, 200));
+    for (int L = lo; L <= hi; ++L) {
+        float x = pos.x + 10.f + gap * (static_cast<float>(L - lo) + 0.5f);
+        float bh = maxH * static_cast<float>(h.lNeededCount(L)) / static_cast<float>(most);
+        sf::Color c = (L == 0) ? sf::Color(120, 220, 140, 220) : sf::Color(230, 120, 120, 220);
+
+        sf::Vector2f tl{x - barW * 0.5f, baseY - bh}, tr{x + barW * 0.5f, baseY - bh};
+        sf::Vector2f bl{x - barW * 0.5f, baseY}, br{x + barW * 0.5f, baseY};
+        for (sf::Vector2f v : {tl, tr, br, tl, br, bl}) bars.append(sf::Vertex{v, c});
+
+        if (L % labelEvery != 0) continue;
+        label.setString(std::to_string(L));
+        auto b = label.getLocalBounds();
+        label.setPosition(sf::Vector2f{x - b.size.x * 0.5f, baseY + 4.f});
+        rt.drawText(label);
+    }
+    rt.draw(bars);
+}
 
-    // Electron spin: biased left-handed (spin opposite momentum) for Mode >= 2
-    bool wantLeft = (u01(rng) < leftHandBias);
-    sf::Vector2f spinE = wantLeft ? vnorm(-dirE) : vnorm(dirE);
+// Draw calls and vertices of the previous frame, by primitive type and by the
+// helper that issued them.
+static void drawProfilerPanel(RenderBackend& rt, const sf::Font& font, sf::Vector2f pos, const RenderStats& st) {
+    DrawTag tag(rt, DrawHelper::Profiler);
+
+    std::ostringstream ss;
+    ss << "Last frame (D hides)\n";
+    ss << st.total.calls << " draw calls, " << st.total.vertices << " vertices, " << st.total.stateChanges
+       << " state changes\n\n";
+    for (int i = 0; i < kPrimitiveTypes; ++i) {
+        const DrawCount& c = st.byPrimitive[static_cast<std::size_t>(i)];
+        if (c.calls)
+            ss << primitiveName(static_cast<sf::PrimitiveType>(i)) << ": " << c.calls << " / " << c.vertices << " / "
+               << c.stateChanges << "\n";
+    }
+    ss << "\n";
+    for (int i = 0; i < kDrawHelperCount; ++i) {
+        const DrawCount& c = st.byHelper[static_cast<std::size_t>(i)];
+        if (c.calls)
+            ss << drawHelperName(static_cast<DrawHelper>(i)) << ": " << c.calls << " / " << c.vertices << " / "
+               << c.stateChanges << "\n";
+    }
 
-    // Anti-neutrino forced right-handed (spin aligned with its momentum) for Mode >= 2
-    sf::Vector2f spinNu = vnorm(dirNu);
+    sf::Text text(font);
+    text.setCharacterSize(14);
+    text.setFillColor(sf::Color(230, 230, 230));
+    text.setPosition(pos + sf::Vector2f{10.f, 8.f});
+    text.setString(ss.str());
 
-    ev.electron.name = "e-";
-    ev.electron.pos = origin;
-    ev.electron.vel = dirE * 260.f;
-    ev.electron.spinDir = spinE;
-    ev.electron.radius = 8.f;
-    ev.electron.color = sf::Color(240, 210, 80);
+    auto b = text.getLocalBounds();
+    rt.drawShape(hudPanel(pos, sf::Vector2f{std::max(200.f, b.size.x + 24.f), b.position.y + b.size.y + 20.f}));
+    rt.drawText(text);
+}
 
-    ev.antinu.name = "anti-nu";
-    ev.antinu.pos = origin;
-    ev.antinu.vel = dirNu * 260.f;
-    ev.antinu.spinDir = spinNu;
-    ev.antinu.radius = 6.f;
-    ev.antinu.color = sf::Color(120, 190, 255);
+// Live activity against N0/tau e^(-t/tau) and the survival curve on a log
+// scale, where an exponential decay is a straight line (dashed: expected).
+static void drawPopulationPanel(RenderBackend& rt, const sf::Font& font, sf::Vector2f pos, const Population& pop,
+                                const DecayHistograms& released) {
+    DrawTag tag(rt, DrawHelper::Population);
+    const sf::Vector2f size{300.f, 280.f};
+    rt.drawShape(hudPanel(pos, size));
+
+    std::ostringstream ss;
+    ss << "Population: " << pop.initial() << (pop.leaping() ? " neutrons (tau-leaped)" : " neutrons") << ", tau = "
+       << std::fixed << std::setprecision(1) << pop.lifetime() << " s\n";
+    ss << "t = " << pop.time() << " s, " << pop.survivors() << " left\n";
+    ss << "activity " << std::setprecision(0) << pop.activity() << " /s (expected " << pop.expectedActivity() << ")\n";
+    ss << "claim looks true in " << std::setprecision(1) << 100.0 * released.claimFraction() << "% of " << released.events
+       << (pop.leaping() ? " sampled" : "") << " decays";
+
+    sf::Text text(font);
+    text.setCharacterSize(14);
+    text.setFillColor(sf::Color(230, 230, 230));
+    text.setPosition(pos + sf::Vector2f{10.f, 8.f});
+    text.setString(ss.str());
+    rt.drawText(text);
+
+    // Plot area: x over the curve's full span, y = log10(survivors) from 0 to log10(N0)
+    const sf::Vector2f plotPos{pos.x + 34.f, pos.y + 96.f};
+    const sf::Vector2f plotSize{size.x - 46.f, size.y - 120.f};
+    const float tMax = static_cast<float>(pop.lifetime()) * Population::kCurvePoints / Population::kCurveStepsPerLifetime;
+    const float decades = std::max(1.f, std::log10(static_cast<float>(std::max<std::uint64_t>(pop.initial(), 10))));
+    auto toPlot = [&](float t, double n) {
+        float y = n >= 1.0 ? static_cast<float>(std::log10(n)) / decades : 0.f;
+        return sf::Vector2f{plotPos.x + plotSize.x * std::min(1.f, t / tMax), plotPos.y + plotSize.y * (1.f - y)};
+    };
 
-    ev.protonSpinSign = pm01(rng) ? +1 : -1;
+    sf::RectangleShape frame(plotSize);
+    frame.setPosition(plotPos);
+    frame.setFillColor(sf::Color::Transparent);
+    frame.setOutlineThickness(1.f);
+    frame.setOutlineColor(sf::Color(80, 90, 110));
+    rt.drawShape(frame);
+
+    sf::VertexArray expected(sf::PrimitiveType::Lines);
+    const int dashes = 40;
+    for (int i = 0; i < dashes; ++i) {
+        for (int end = 0; end < 2; ++end) {
+            float t = tMax * (static_cast<float>(i) + 0.6f * static_cast<float>(end)) / dashes;
+            double n = static_cast<double>(pop.initial()) * std::exp(-t / pop.lifetime());
+            expected.append(sf::Vertex{toPlot(t, n), sf::Color(150, 150, 150, 200)});
+        }
+    }
+    rt.draw(expected);
 
-    // MODE 1: enforce the oversimplified myth visually: spins are always opposite.
-    // Hide the real relationship between helicity and motion by construction.
-    if (mode == Mode::SpinOnly) {
-        // Keep motion for animation, but force spin cancellation in "space":
-        ev.antinu.spinDir = vnorm(-ev.electron.spinDir);
+    sf::VertexArray survival(sf::PrimitiveType::LineStrip);
+    for (const SurvivalPoint& p : pop.curve()) {
+        survival.append(sf::Vertex{toPlot(p.t, static_cast<double>(p.survivors)), sf::Color(120, 220, 140)});
     }
+    survival.append(sf::Vertex{toPlot(static_cast<float>(pop.time()), static_cast<double>(pop.survivors())),
+                               sf::Color(120, 220, 140)});
+    rt.draw(survival);
+
+    sf::Text axis(font);
+    axis.setCharacterSize(12);
+    axis.setFillColor(sf::Color(200, 200, 200));
+    axis.setString("1e" + std::to_string(static_cast<int>(decades)));
+    axis.setPosition(sf::Vector2f{pos.x + 6.f, plotPos.y - 6.f});
+    rt.drawText(axis);
+    axis.setString("1");
+    axis.setPosition(sf::Vector2f{pos.x + 18.f, plotPos.y + plotSize.y - 8.f});
+    rt.drawText(axis);
+    std::ostringstream xs;
+    xs << std::fixed << std::setprecision(0) << tMax << " s";
+    axis.setString(xs.str());
+    axis.setPosition(sf::Vector2f{plotPos.x + plotSize.x - 36.f, plotPos.y + plotSize.y + 2.f});
+    rt.drawText(axis);
+}
 
-    // Toy integer bookkeeping for L_needed (used in Mode 3 as "orbital placeholder")
-    int sP = ev.protonSpinSign;
-    int sE = (ev.electron.spinDir.y >= 0.f) ? +1 : -1;
-    int sN = (ev.antinu.spinDir.y >= 0.f) ? +1 : -1;
-    ev.L_needed = ev.neutronSpinSign - (sP + sE + sN);
+// Energies of the charged lepton `who` so far as bars, with the channel's
+// allowed spectrum they should fill in drawn over them.
+static void drawSpectrumPanel(RenderBackend& rt, const sf::Font& font, sf::Vector2f pos, const EnergyHistogram& h,
+                              const BetaSpectrum& shape, const std::string& who) {
+    DrawTag tag(rt, DrawHelper::Spectrum);
+    const sf::Vector2f size{260.f, 130.f};
+    rt.drawShape(hudPanel(pos, size));
+
+    sf::Text text(font);
+    text.setCharacterSize(14);
+    text.setFillColor(sf::Color(230, 230, 230));
+    text.setPosition(pos + sf::Vector2f{10.f, 6.f});
+    text.setString(who + " energy, " + std::to_string(h.events) + " decays");
+    rt.drawText(text);
+
+    const float left = pos.x + 10.f, baseY = pos.y + size.y - 22.f;
+    const float plotW = size.x - 20.f, maxH = size.y - 52.f;
+    const float binW = plotW / EnergyHistogram::kBins;
+    const float binMeV = h.endpoint / EnergyHistogram::kBins;
+
+    // Tallest of bars and expectation maps to maxH
+    double most = 1.0;
+    for (int i = 0; i < EnergyHistogram::kBins; ++i) {
+        double expected = static_cast<double>(h.events) * shape.density((static_cast<float>(i) + 0.5f) * binMeV) * binMeV;
+        most = std::max({most, static_cast<double>(h.counts[static_cast<std::size_t>(i)]), expected});
+    }
 
-    return ev;
-}
+    sf::VertexArray bars(sf::PrimitiveType::Triangles);
+    sf::VertexArray curve(sf::PrimitiveType::LineStrip);
+    const sf::Color barColor(240, 210, 80, 200);
+    for (int i = 0; i < EnergyHistogram::kBins; ++i) {
+        float x0 = left + binW * static_cast<float>(i), x1 = x0 + binW - 1.f;
+        float bh = maxH * static_cast<float>(static_cast<double>(h.counts[static_cast<std::size_t>(i)]) / most);
+        for (sf::Vector2f v : {sf::Vector2f{x0, baseY - bh}, sf::Vector2f{x1, baseY - bh}, sf::Vector2f{x1, baseY},
+                               sf::Vector2f{x0, baseY - bh}, sf::Vector2f{x1, baseY}, sf::Vector2f{x0, baseY}}) {
+            bars.append(sf::Vertex{v, barColor});
+        }
 
-static sf::RectangleShape hudPanel(sf::Vector2f pos, sf::Vector2f size) {
-    sf::RectangleShape r(size);
-    r.setPosition(pos);
-    r.setFillColor(sf::Color(10, 12, 16, 200));
-    r.setOutlineThickness(1.f);
-    r.setOutlineColor(sf::Color(80, 90, 110, 180));
-    return r;
+        float tMid = (static_cast<float>(i) + 0.5f) * binMeV;
+        double expected = static_cast<double>(h.events) * shape.density(tMid) * binMeV;
+        curve.append(sf::Vertex{sf::Vector2f{x0 + binW * 0.5f, baseY - maxH * static_cast<float>(expected / most)},
+                                sf::Color(230, 230, 230, 200)});
+    }
+    rt.draw(bars);
+    if (h.events > 0) rt.draw(curve);
+
+    sf::Text axis(font);
+    axis.setCharacterSize(12);
+    axis.setFillColor(sf::Color(200, 200, 200));
+    axis.setString("0");
+    axis.setPosition(sf::Vector2f{left, baseY + 3.f});
+    rt.drawText(axis);
+    std::ostringstream q;
+    q << std::fixed << std::setprecision(3) << h.endpoint << " MeV";
+    axis.setString(q.str());
+    axis.setPosition(sf::Vector2f{left + plotW - 62.f, baseY + 3.f});
+    rt.drawText(axis);
 }
 
 static std::string modeTitle(Mode m) {
@@ -282,394 +400,2051 @@ static std::string modeTitle(Mode m) {
     return "MODE 3: Full conservation (orbital placeholder shown)";
 }
 
-int main() {
-    sf::RenderWindow window(
-        sf::VideoMode(sf::Vector2u{1100u, 700u}),
-        sf::String("Beta Decay Viz (Learning Tool)"),
-        sf::Style::Titlebar | sf::Style::Close
-    );
-    window.setVerticalSyncEnabled(true);
+struct Options {
+    // Headless runs: --batch prints statistics, --record-log stores the decays.
+    bool batch = false;
+    bool sweep = false;
+    bool paired = false;
+    bool correlation = false;
+    unsigned threads = 0;
+    std::string recordLog;
+    std::uint64_t events = 100000;
+    Mode mode = Mode::SpinOnly;
+    float leftHandBias = 0.85f;
+    float polarization = 1.f; // spin-up fraction of the decaying neutrons
+    bool asymmetry = false;   // --batch: stream the electron up/down asymmetry while running
+    ChannelMix channels;      // headless runs draw from the mix; the window starts on the first channel
+    std::string channelList;  // --channels, parsed once the nuclides are in the channel table
+
+    // Isotopes looked up in the nuclide database and added as decay channels;
+    // convertNuclides builds that database from a text table instead.
+    std::vector<std::string> nuclides;
+    std::string nuclideDb = "nuclides.bin";
+    std::string convertNuclides;
+
+    std::uint64_t seed = 0;
+    bool haveSeed = false;
+
+    // --sweep grids; --events is then per cell.
+    std::vector<float> biasGrid = gridValues(0.01f, 0.99f, 0.02f);
+    std::vector<float> spreadGrid{kAngleSpread};
+    std::vector<Mode> sweepModes{Mode::SpinOnly, Mode::SpinAndMotion, Mode::FullConservation};
+
+    // Early stopping for --batch/--sweep: --events becomes the budget.
+    double targetHalfWidth = 0.0;
+    double confidence = 0.95;
+
+    // --batch: source of the angle and coin draws; --batch, --paired and --record-log: three-body kinematics.
+    Sampler sampler = Sampler::Pseudo;
+    bool threeBody = false;
+
+    // Replay: show the decays stored in replayLog instead of generating new ones.
+    std::string replayLog;
+    std::uint64_t replayStart = 0;
+
+    // Headless rendering on the CPU: renderFrames frames at a fixed 60 Hz step into renderDir.
+    std::uint64_t renderFrames = 0;
+    std::string renderDir = ".";
+    FrameFormat frameFormat = FrameFormat::Png;
+    // Window session written to renderDir frame by frame, also at a fixed 60 Hz step.
+    bool recordFrames = false;
+
+    // Headless and uncapped: simFrames frames of scene code drawn into a backend that only counts.
+    std::uint64_t simFrames = 0;
+
+    // Window benchmark: benchFrames frames of a scripted scene without vsync.
+    std::uint64_t benchFrames = 0;
+
+    // Chrome trace-event JSON of frame phases and worker tasks, written on exit.
+    std::string traceFile;
+
+    // Population mode: that many neutrons with mean lifetime `lifetime` seconds,
+    // tau-leaped rather than scheduled one by one if tauLeap or very large.
+    std::uint64_t population = 0;
+    float lifetime = 10.f;
+    bool tauLeap = false;
+
+    // Cloud view: that many decays on screen at once (V toggles it in the
+    // window), drawn at a fixed detail level or, with -1, as the budget allows.
+    std::uint64_t cloud = 0;
+    int cloudDetail = -1;
+
+    // Keyboard session recording and exact replay; replayFast drops vsync.
+    std::string recordInput;
+    std::string replayInput;
+    bool replayFast = false;
+};
 
-    sf::Font font;
-    bool hasFont = font.openFromFile("Arial.ttf") || font.openFromFile("DejaVuSans.ttf");
-
-    const std::string TIP_NEUTRON_TITLE = "Neutron";
-    const std::string TIP_NEUTRON_BODY =
-        "This is the neutron before it breaks.\n\n"
-        "Think of it like:\n"
-        "  - One heavy ball\n"
-        "  - Sitting still\n"
-        "  - About to split\n\n"
-        "It does nothing else here except exist as the starting point.\n"
-        "It does not move because we are not teaching neutron motion,\n"
-        "only what comes out of it.";
-
-    const std::string TIP_PROTON_TITLE = "Proton";
-    const std::string TIP_PROTON_BODY =
-        "This is the proton after the break.\n\n"
-        "Think:\n"
-        "  - Neutron turns into a proton\n"
-        "  - Proton is heavy\n"
-        "  - So it barely moves\n\n"
-        "In real life it can move, but we keep it still so it doesn't distract you.\n"
-        "Red means: the heavy leftover.";
-
-    const std::string TIP_ELECTRON_TITLE = "Electron (e-)";
-    const std::string TIP_ELECTRON_BODY =
-        "This is the electron.\n\n"
-        "Think:\n"
-        "  - A tiny piece that shoots out fast\n"
-        "  - Light\n"
-        "  - Easy to move\n\n"
-        "The yellow glow just helps your eyes track it.";
-
-    const std::string TIP_ANTINU_TITLE = "Anti-neutrino";
-    const std::string TIP_ANTINU_BODY =
-        "This is the anti-neutrino.\n\n"
-        "Think:\n"
-        "  - Even tinier than the electron\n"
-        "  - Almost invisible in real life\n"
-        "  - Flies off very fast\n\n"
-        "It usually goes roughly the opposite way from the electron.";
-
-    const std::string TIP_MOM_TITLE = "Momentum arrow";
-    const std::string TIP_MOM_BODY =
-        "This arrow means:\n"
-        "\"Which way is this thing moving?\"";
-
-    const std::string TIP_SPIN_TITLE = "Spin arrow";
-    const std::string TIP_SPIN_BODY =
-        "This arrow means:\n"
-        "\"Which way is this thing spinning?\"\n\n"
-        "This is the important one for the misconception.";
-
-    const std::string TIP_SWIRL_TITLE = "Swirl (extra angular momentum)";
-    const std::string TIP_SWIRL_BODY =
-        "This swirl means:\n"
-        "\"Something is missing if you only count spins.\" \n\n"
-        "When the spins do not add up, motion must carry the extra turning.\n"
-        "No swirl: spins alone work.\n"
-        "Swirl: spins alone do not work.";
-
-
-    std::mt19937 rng(static_cast<unsigned int>(std::random_device{}()));
-
-    const sf::FloatRect arena(sf::Vector2f{60.f, 60.f}, sf::Vector2f{980.f, 580.f});
-    sf::Vector2f origin(arena.position.x + 140.f, arena.position.y + arena.size.y * 0.5f);
+static bool parseU64(const char* s, std::uint64_t& out) {
+    char* end = nullptr;
+    unsigned long long v = std::strtoull(s, &end, 10);
+    if (end == s || *end != '\0') return false;
+    out = v;
+    return true;
+}
+
+// A whole number, also written like 1e12.
+static bool parseCount(const char* s, std::uint64_t& out) {
+    if (parseU64(s, out)) return true;
+    char* end = nullptr;
+    double v = std::strtod(s, &end);
+    if (end == s || *end != '\0' || !(v >= 0.0) || v >= 1.8e19 || v != std::floor(v)) return false;
+    out = static_cast<std::uint64_t>(v);
+    return true;
+}
+
+static bool parseFloat(const char* s, float& out) {
+    char* end = nullptr;
+    float v = std::strtof(s, &end);
+    if (end == s || *end != '\0') return false;
+    out = v;
+    return true;
+}
+
+static bool parseMode(const char* s, Mode& out) {
+    std::string m(s);
+    if (m == "1") out = Mode::SpinOnly;
+    else if (m == "2") out = Mode::SpinAndMotion;
+    else if (m == "3") out = Mode::FullConservation;
+    else return false;
+    return true;
+}
+
+// FROM:TO:STEP, or a single value.
+static bool parseGrid(const char* s, std::vector<float>& out) {
+    std::string g(s);
+    std::size_t c1 = g.find(':');
+    float from = 0.f, to = 0.f, step = 0.f;
+    if (c1 == std::string::npos) {
+        if (!parseFloat(s, from)) return false;
+        out = {from};
+        return true;
+    }
+    std::size_t c2 = g.find(':', c1 + 1);
+    if (c2 == std::string::npos) return false;
+    if (!parseFloat(g.substr(0, c1).c_str(), from) || !parseFloat(g.substr(c1 + 1, c2 - c1 - 1).c_str(), to) ||
+        !parseFloat(g.substr(c2 + 1).c_str(), step) || step <= 0.f || to < from) {
+        return false;
+    }
+    out = gridValues(from, to, step);
+    return true;
+}
+
+// Digits 1-3, e.g. "13".
+static bool parseModes(const char* s, std::vector<Mode>& out) {
+    out.clear();
+    for (const char* p = s; *p; ++p) {
+        char one[2] = {*p, '\0'};
+        Mode m;
+        if (!parseMode(one, m)) return false;
+        out.push_back(m);
+    }
+    return !out.empty();
+}
+
+// "Co-60,F-18" into its names.
+static bool parseNames(const char* s, std::vector<std::string>& out) {
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) return false;
+        out.push_back(item);
+    }
+    return !out.empty();
+}
+
+// "auto" or a CloudDetail level, 0 (full) to 4.
+static bool parseCloudDetail(const char* s, int& out) {
+    if (std::string(s) == "auto") {
+        out = -1;
+        return true;
+    }
+    std::uint64_t v = 0;
+    if (!parseU64(s, v) || v >= static_cast<std::uint64_t>(kCloudDetailLevels)) return false;
+    out = static_cast<int>(v);
+    return true;
+}
+
+static bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool ok = (v != nullptr);
+
+        if (a == "--batch") {
+            opt.batch = true;
+            continue;
+        }
+        if (a == "--sweep") {
+            opt.sweep = true;
+            continue;
+        }
+        if (a == "--paired") {
+            opt.paired = true;
+            continue;
+        }
+        if (a == "--correlation") {
+            opt.correlation = true;
+            continue;
+        }
+        if (a == "--asymmetry") {
+            opt.asymmetry = true;
+            continue;
+        }
+        if (a == "--record-frames") {
+            opt.recordFrames = true;
+            continue;
+        }
+        if (a == "--three-body") {
+            opt.threeBody = true;
+            continue;
+        }
+        if (a == "--tau-leap") {
+            opt.tauLeap = true;
+            continue;
+        }
+        if (a == "--replay-fast") {
+            opt.replayFast = true;
+            continue;
+        }
+
+        if (a == "--record-log" && ok) opt.recordLog = v;
+        else if (a == "--replay-log" && ok) opt.replayLog = v;
+        else if (a == "--replay-start" && ok) ok = parseU64(v, opt.replayStart);
+        else if (a == "--render-frames" && ok) ok = parseU64(v, opt.renderFrames);
+        else if (a == "--render-dir" && ok) opt.renderDir = v;
+        else if (a == "--frame-format" && ok) ok = parseFrameFormat(v, opt.frameFormat);
+        else if (a == "--sim-frames" && ok) ok = parseU64(v, opt.simFrames) && opt.simFrames > 0;
+        else if (a == "--bench-frames" && ok) ok = parseU64(v, opt.benchFrames) && opt.benchFrames > 0;
+        else if (a == "--trace" && ok) opt.traceFile = v;
+        else if (a == "--population" && ok) ok = parseCount(v, opt.population) && opt.population > 0;
+        else if (a == "--cloud" && ok) ok = parseCount(v, opt.cloud) && opt.cloud >= DecayCloud::kMinSize && opt.cloud <= DecayCloud::kMaxSize;
+        else if (a == "--cloud-detail" && ok) ok = parseCloudDetail(v, opt.cloudDetail);
+        else if (a == "--lifetime" && ok) ok = parseFloat(v, opt.lifetime) && opt.lifetime > 0.f;
+        else if (a == "--record-input" && ok) opt.recordInput = v;
+        else if (a == "--replay-input" && ok) opt.replayInput = v;
+        else if (a == "--events" && ok) ok = parseCount(v, opt.events);
+        else if (a == "--threads" && ok) {
+            std::uint64_t n = 0;
+            ok = parseU64(v, n) && n <= 1024;
+            opt.threads = static_cast<unsigned>(n);
+        }
+        else if (a == "--seed" && ok) ok = opt.haveSeed = parseU64(v, opt.seed);
+        else if (a == "--mode" && ok) ok = parseMode(v, opt.mode);
+        else if (a == "--target" && ok) {
+            float w = 0.f;
+            ok = parseFloat(v, w) && w > 0.f && w < 1.f;
+            opt.targetHalfWidth = w;
+        } else if (a == "--confidence" && ok) {
+            float c = 0.f;
+            ok = parseFloat(v, c);
+            if (c > 1.f) c /= 100.f; // allow "99"
+            ok = ok && c > 0.f && c < 1.f;
+            opt.confidence = c;
+        }
+        else if (a == "--sampler" && ok) ok = parseSampler(v, opt.sampler);
+        else if (a == "--modes" && ok) ok = parseModes(v, opt.sweepModes);
+        else if (a == "--bias-grid" && ok) ok = parseGrid(v, opt.biasGrid);
+        else if (a == "--spread-grid" && ok) ok = parseGrid(v, opt.spreadGrid);
+        else if (a == "--bias" && ok) ok = parseFloat(v, opt.leftHandBias) && opt.leftHandBias >= 0.f && opt.leftHandBias <= 1.f;
+        else if (a == "--polarization" && ok) ok = parseFloat(v, opt.polarization) && opt.polarization >= 0.f && opt.polarization <= 1.f;
+        else if (a == "--channels" && ok) opt.channelList = v;
+        else if (a == "--nuclide" && ok) ok = parseNames(v, opt.nuclides);
+        else if (a == "--nuclide-db" && ok) opt.nuclideDb = v;
+        else if (a == "--convert-nuclides" && ok) opt.convertNuclides = v;
+        else {
+            std::cerr << "unknown or incomplete option: " << a << "\n";
+            return false;
+        }
+
+        if (!ok) {
+            std::cerr << "bad value for " << a << ": " << v << "\n";
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+static void printUsage() {
+    std::cerr << "usage: BetaDecayViz [--seed S] [--polarization P] [--channels LIST] [--trace FILE]\n"
+                 "                    [--replay-log FILE [--replay-start N]]\n"
+                 "                    [--record-input FILE | --replay-input FILE [--replay-fast]]\n"
+                 "                    [--population N [--lifetime S] [--tau-leap]]\n"
+                 "                    [--cloud N] [--cloud-detail auto|0-4]\n"
+                 "                    [--record-frames [--render-dir DIR] [--frame-format png|ppm]]\n"
+                 "       BetaDecayViz --render-frames N [--render-dir DIR] [--frame-format png|ppm] [--threads T]\n"
+                 "                    [--seed S] [--replay-log FILE]\n"
+                 "       BetaDecayViz --sim-frames N [--seed S] [--replay-log FILE | --replay-input FILE]\n"
+                 "       BetaDecayViz --bench-frames N [--seed S]\n"
+                 "       --trace FILE works with every mode and writes a Chrome/Perfetto timeline on exit\n"
+                 "       BetaDecayViz --record-log FILE [--events N] [--mode 1|2|3] [--bias B] [--seed S] [--three-body]\n"
+                 "                    [--polarization P] [--channels LIST]\n"
+                 "       BetaDecayViz --batch [--events N] [--threads T] [--mode 1|2|3] [--bias B] [--seed S]\n"
+                 "                    [--target W [--confidence C]] [--sampler pseudo|stratified|sobol] [--three-body]\n"
+                 "                    [--polarization P] [--asymmetry] [--channels LIST]\n"
+                 "       BetaDecayViz --correlation [--events N] [--threads T] [--mode 1|2|3] [--bias B] [--seed S]\n"
+                 "                    [--sampler pseudo|stratified|sobol] [--polarization P] [--channels LIST]\n"
+                 "       BetaDecayViz --paired [--events N] [--threads T] [--bias B] [--seed S] [--sampler NAME]\n"
+                 "                    [--three-body] [--channels LIST]\n"
+                 "       LIST is beta-, beta+ or ec, or weighted as beta-:0.5,beta+:0.3,ec:0.2\n"
+                 "       --nuclide Co-60,F-18 [--nuclide-db FILE] adds isotopes as channels, named like that in LIST\n"
+                 "       BetaDecayViz --convert-nuclides TEXT [--nuclide-db FILE]\n"
+                 "       BetaDecayViz --sweep [--events N] [--threads T] [--modes 123] [--bias-grid A:B:STEP]\n"
+                 "                    [--spread-grid A:B:STEP] [--seed S] [--target W [--confidence C]]\n"
+                 "                    [--sampler NAME] [--three-body] [--polarization P] [--channels LIST]\n";
+}
+
+static BatchConfig batchConfig(const Options& opt) {
+    BatchConfig cfg;
+    cfg.events = opt.events;
+    cfg.threads = opt.threads;
+    cfg.seed = opt.seed;
+    cfg.mode = opt.mode;
+    cfg.leftHandBias = opt.leftHandBias;
+    cfg.targetHalfWidth = opt.targetHalfWidth;
+    cfg.confidence = opt.confidence;
+    cfg.sampler = opt.sampler;
+    cfg.threeBody = opt.threeBody;
+    cfg.polarization = opt.polarization;
+    cfg.channels = opt.channels;
+    return cfg;
+}
+
+// "beta-" or "beta-:0.500,ec:0.500", for run headers.
+static std::string channelMixName(const ChannelMix& mix) {
+    const DecayChannels& ch = decayChannels();
+    if (!mix.needsDraw()) return ch.key[mix.first()];
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(3);
+    float prev = 0.f;
+    for (int i = 0; i < mix.count; ++i) {
+        const std::size_t k = static_cast<std::size_t>(i);
+        os << (i ? "," : "") << ch.key[mix.id[k]] << ":" << mix.cdf[k] - prev;
+        prev = mix.cdf[k];
+    }
+    return os.str();
+}
+
+// Spins, transition and half-life of each channel in the mix, for run headers.
+static void printChannelDetails(std::ostream& os, const ChannelMix& mix) {
+    const DecayChannels& ch = decayChannels();
+    for (int i = 0; i < mix.count; ++i) {
+        const std::size_t id = mix.id[static_cast<std::size_t>(i)];
+        os << "  " << ch.title[id] << ": " << ch.detail[id] << ", Q " << std::setprecision(4) << ch.q[id] << " MeV\n";
+    }
+}
+
+static void printHistograms(std::ostream& os, const DecayHistograms& h) {
+    os << std::fixed << std::setprecision(6);
+    os << "events: " << h.events << "\n";
+    os << "P(claim looks true): " << h.claimFraction() << "\n";
+    os << "mean |L_needed|: " << h.meanAbsL() << "\n";
+
+    auto frac = [&](std::uint64_t n) { return h.events ? static_cast<double>(n) / static_cast<double>(h.events) : 0.0; };
+
+    os << "\nL_needed histogram\n";
+    int lo = 0, hi = 0;
+    h.lShown(lo, hi);
+    for (int L = lo; L <= hi; ++L) {
+        os << std::setw(4) << L << "  " << std::setw(12) << h.lNeededCount(L) << "  " << frac(h.lNeededCount(L)) << "\n";
+    }
+
+    os << "\nspin dot histogram (bin centre)\n";
+    os << std::setprecision(2);
+    for (int b = 0; b < DecayHistograms::kSpinDotBins; ++b) {
+        std::uint64_t n = h.spinDot[static_cast<std::size_t>(b)];
+        if (n) os << std::setw(6) << DecayHistograms::spinDotBinCenter(b) << "  " << std::setw(12) << n << "\n";
+    }
+
+    os << "\nhelicity table (rows electron, columns anti-nu)\n";
+    os << "          hN=-1         hN=+1\n";
+    for (int hE : {-1, +1}) {
+        os << "hE=" << (hE > 0 ? "+1" : "-1") << "  " << std::setw(12) << h.helicityCount(hE, -1) << "  "
+           << std::setw(12) << h.helicityCount(hE, +1) << "\n";
+    }
+
+    os << "\nelectron emission (rows neutron spin, columns electron direction.y)\n";
+    os << "                 < 0          >= 0\n";
+    for (int n : {-1, +1}) {
+        os << "n=" << (n > 0 ? "+1" : "-1") << "   " << std::setw(12) << h.emissionCount(n, -1) << "  " << std::setw(12)
+           << h.emissionCount(n, +1) << "\n";
+    }
+
+    if (h.channel[0] != h.events) {
+        os << "\ndecay channels\n";
+        const DecayChannels& ch = decayChannels();
+        for (int c = 0; c < ch.count; ++c) {
+            std::uint64_t n = h.channel[static_cast<std::size_t>(c)];
+            if (n) os << std::left << std::setw(28) << ch.title[static_cast<std::size_t>(c)] << std::right
+                      << std::setw(12) << n << "  " << std::setprecision(6) << frac(n) << "\n";
+        }
+    }
+}
+
+// Up/down asymmetry of the electron direction, the same relative to each
+// neutron's spin, and the polarization the sample actually had.
+static void printAsymmetries(std::ostream& os, const DecayHistograms& h) {
+    auto row = [&](const char* name, Asymmetry a) {
+        os << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(6) << std::setw(10)
+           << a.value << "  +- " << std::scientific << std::setprecision(3) << a.err << std::fixed << "\n";
+    };
+    row("electron up/down asymmetry", countAsymmetry(h.electronUp(), h.events));
+    row("electron asymmetry along n spin", countAsymmetry(h.electronWithSpin(), h.events));
+    row("neutron polarization 2P - 1", countAsymmetry(h.neutronUp(), h.events));
+}
+
+// Block-to-block variance of the sampler's estimators next to plain
+// pseudo-random sampling of the same size.
+static void printSamplerComparison(std::ostream& os, const BatchConfig& cfg, const BatchResult& res) {
+    BatchConfig plainCfg = cfg;
+    plainCfg.sampler = Sampler::Pseudo;
+    plainCfg.targetHalfWidth = 0.0;
+    plainCfg.events = 0;
+    for (const BlockEstimate& e : res.blocks) plainCfg.events += e.events;
+    BatchResult plain = runBatch(plainCfg);
+
+    struct Row {
+        const char* name;
+        double (*get)(const BlockEstimate&);
+    };
+    const Row rows[] = {
+        {"mean spin dot", [](const BlockEstimate& e) { return e.meanSpinDot; }},
+        {"P(electron spin.y >= 0)", [](const BlockEstimate& e) { return e.electronSpinUp; }},
+        {"P(claim looks true)", [](const BlockEstimate& e) { return e.claimTrue; }},
+    };
+
+    os << "\nvariance of per-block estimates (" << kBatchBlock << " events per block)\n";
+    os << "estimator                    " << std::setw(12) << samplerName(cfg.sampler) << std::setw(14) << "pseudo"
+       << "   reduction\n";
+    for (const Row& r : rows) {
+        RunningStat a = blockSpread(res.blocks, r.get);
+        RunningStat b = blockSpread(plain.blocks, r.get);
+        os << std::left << std::setw(27) << r.name << std::right << std::scientific << std::setprecision(3)
+           << std::setw(14) << a.variance() << std::setw(14) << b.variance() << std::fixed << std::setprecision(1);
+        if (a.n < 2) os << "   (need 2+ full blocks)\n";
+        else if (a.variance() > 0.0) os << std::setw(10) << b.variance() / a.variance() << "x\n";
+        else os << "     exact\n";
+    }
+}
+
+static int runBatchCli(const Options& opt) {
+    BatchConfig cfg = batchConfig(opt);
+
+    // With --asymmetry every checkpoint prints a line to stdout, so a run of
+    // billions of events can be watched (or piped) while it converges.
+    if (opt.asymmetry) {
+        std::cout << "      events   up/down asymmetry        s.e.   along n spin        s.e.\n";
+    }
+    auto start = std::chrono::steady_clock::now();
+    BatchResult res = runBatch(cfg, [&](const DecayHistograms& partial) {
+        if (!opt.asymmetry) {
+            std::cerr << "  " << partial.events << " / " << cfg.events << " events\r" << std::flush;
+            return;
+        }
+        Asymmetry up = countAsymmetry(partial.electronUp(), partial.events);
+        Asymmetry along = countAsymmetry(partial.electronWithSpin(), partial.events);
+        std::cout << std::setw(12) << partial.events << std::fixed << std::setprecision(6) << std::setw(20) << up.value
+                  << std::scientific << std::setprecision(3) << std::setw(12) << up.err << std::fixed
+                  << std::setprecision(6) << std::setw(15) << along.value << std::scientific << std::setprecision(3)
+                  << std::setw(12) << along.err << std::fixed << std::endl;
+    });
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const DecayHistograms& h = res.hist;
+
+    std::cerr << "\n";
+    std::cout << "mode " << static_cast<int>(cfg.mode) << "   left bias " << std::fixed << std::setprecision(2)
+              << cfg.leftHandBias << "   seed " << cfg.seed << "   threads " << batchThreads(cfg.threads)
+              << "   sampler " << samplerName(cfg.sampler) << (cfg.threeBody ? "   three-body" : "")
+              << "   polarization " << cfg.polarization << "   channels " << channelMixName(cfg.channels) << "\n";
+    if (!opt.nuclides.empty()) printChannelDetails(std::cout, cfg.channels);
+    printHistograms(std::cout, h);
+    std::cout << "\n";
+    printAsymmetries(std::cout, h);
+    if (cfg.targetHalfWidth > 0.0) {
+        double hw = wilsonHalfWidth(h.claimTrue, h.events, zForConfidence(cfg.confidence));
+        std::cout << std::setprecision(6) << "\nP(claim looks true) +- " << hw << " at " << std::setprecision(1)
+                  << cfg.confidence * 100.0 << "% after " << h.events << " of at most " << cfg.events << " events"
+                  << (hw <= cfg.targetHalfWidth ? "" : " (target not reached)") << "\n";
+    }
+    if (cfg.sampler != Sampler::Pseudo) printSamplerComparison(std::cout, cfg, res);
+    std::cout << std::setprecision(3) << "\n" << secs << " s, " << std::setprecision(1)
+              << (secs > 0.0 ? static_cast<double>(h.events) / secs / 1e6 : 0.0) << " M events/s\n";
+    return 0;
+}
+
+static int runPairedCli(const Options& opt) {
+    BatchConfig cfg = batchConfig(opt);
+
+    auto start = std::chrono::steady_clock::now();
+    PairedStats st = runPaired(cfg);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "all modes on the same draws   left bias " << std::fixed << std::setprecision(2) << cfg.leftHandBias
+              << "   seed " << cfg.seed << "   sampler " << samplerName(cfg.sampler)
+              << (cfg.threeBody ? "   three-body" : "") << "   channels " << channelMixName(cfg.channels) << "   events "
+              << st.events() << "\n\n";
+
+    std::cout << "mode  P(claim true)  mean |L_needed|\n";
+    for (int m = 0; m < kModeCount; ++m) {
+        const DecayHistograms& h = st.perMode[static_cast<std::size_t>(m)];
+        std::cout << std::setw(4) << m + 1 << std::setprecision(6) << std::setw(15) << h.claimFraction() << std::setw(17)
+                  << h.meanAbsL() << "\n";
+    }
+
+    std::cout << "\nclaim looks true in modes (1 2 3)   events\n";
+    for (std::size_t p = 0; p < st.claimPattern.size(); ++p) {
+        if (!st.claimPattern[p]) continue;
+        std::cout << "                           ";
+        for (int m = 0; m < kModeCount; ++m) std::cout << (((p >> m) & 1u) ? " y" : " n");
+        std::cout << std::setw(12) << st.claimPattern[p] << "\n";
+    }
+
+    // Standard error of a difference of two independent runs of the same size, for comparison.
+    auto independentErr = [&](double va, double vb) { return std::sqrt((va + vb) / static_cast<double>(st.events())); };
+
+    std::cout << "\ndifference          paired mean    paired s.e.  independent s.e.\n";
+    for (int a = 0; a < kModeCount; ++a) {
+        for (int b = a + 1; b < kModeCount; ++b) {
+            const DecayHistograms& ha = st.perMode[static_cast<std::size_t>(a)];
+            const DecayHistograms& hb = st.perMode[static_cast<std::size_t>(b)];
+            double mean = 0.0, err = 0.0;
+
+            st.claimDiff(a, b, mean, err);
+            double pa = ha.claimFraction(), pb = hb.claimFraction();
+            std::cout << "P(claim) " << a + 1 << "-" << b + 1 << "     " << std::setprecision(6) << std::setw(14) << mean
+                      << std::scientific << std::setprecision(3) << std::setw(15) << err << std::setw(18)
+                      << independentErr(pa * (1.0 - pa), pb * (1.0 - pb)) << std::fixed << "\n";
+
+            st.absLDiffStats(a, b, mean, err);
+            std::cout << "|L_needed| " << a + 1 << "-" << b + 1 << "   " << std::setprecision(6) << std::setw(14) << mean
+                      << std::scientific << std::setprecision(3) << std::setw(15) << err << std::setw(18)
+                      << independentErr(absLVariance(ha), absLVariance(hb)) << std::fixed << "\n";
+        }
+    }
+
+    std::cerr << std::setprecision(3) << secs << " s\n";
+    return 0;
+}
+
+static int runCorrelationCli(const Options& opt) {
+    BatchConfig cfg = batchConfig(opt);
+    cfg.threeBody = true;
+
+    auto start = std::chrono::steady_clock::now();
+    CorrelationEstimate e = estimateCorrelation(runCorrelation(cfg));
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "three-body correlation   mode " << static_cast<int>(cfg.mode) << "   left bias " << std::fixed
+              << std::setprecision(2) << cfg.leftHandBias << "   seed " << cfg.seed << "   sampler "
+              << samplerName(cfg.sampler) << "   polarization " << cfg.polarization << "   channels "
+              << channelMixName(cfg.channels) << "   events " << e.events << "\n\n";
+    auto row = [](const char* name, double value, double err) {
+        std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(6)
+                  << std::setw(12) << value << "  +- " << std::scientific << std::setprecision(3) << err << "\n";
+    };
+    row("a (3 <beta cos> / <beta^2>)", e.a, e.aErr);
+    if (cfg.channels.needsDraw()) {
+        std::cout << "  input a differs by channel; the estimate is their beta^2-weighted mean\n";
+    } else {
+        std::cout << std::fixed << std::setprecision(4) << "  input a = "
+                  << decayChannels().correlationA[cfg.channels.first()] << "\n";
+    }
+    row("<cos(e, anti-nu)>", e.meanCos, e.meanCosErr);
+    std::cout << std::left << std::setw(30) << "<beta>" << std::right << std::fixed << std::setprecision(6)
+              << std::setw(12) << e.meanBeta << "\n";
+    row("helicity asymmetry electron", e.helicityE, e.helicityEErr);
+    row("helicity asymmetry anti-nu", e.helicityNu, e.helicityNuErr);
+
+    std::cerr << std::fixed << std::setprecision(3) << secs << " s, " << std::setprecision(1)
+              << (secs > 0.0 ? static_cast<double>(e.events) / secs / 1e6 : 0.0) << " M events/s\n";
+    return 0;
+}
+
+static int runSweepCli(const Options& opt) {
+    SweepConfig cfg;
+    cfg.modes = opt.sweepModes;
+    cfg.biases = opt.biasGrid;
+    cfg.spreads = opt.spreadGrid;
+    cfg.eventsPerCell = opt.events;
+    cfg.threads = opt.threads;
+    cfg.seed = opt.seed;
+    cfg.targetHalfWidth = opt.targetHalfWidth;
+    cfg.confidence = opt.confidence;
+    cfg.sampler = opt.sampler;
+    cfg.threeBody = opt.threeBody;
+    cfg.polarization = opt.polarization;
+    cfg.channels = opt.channels;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SweepCell> cells = runSweep(cfg);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "# " << cells.size() << " cells x " << cfg.eventsPerCell << " events, seed " << cfg.seed << ", sampler "
+              << samplerName(cfg.sampler) << (cfg.threeBody ? ", three-body" : "") << ", polarization " << cfg.polarization << ", channels "
+              << channelMixName(cfg.channels) << "\n";
+    if (cfg.targetHalfWidth > 0.0) {
+        std::cout << "# stopping each cell at +-" << cfg.targetHalfWidth << " (" << cfg.confidence * 100.0 << "% confidence)\n";
+    }
+    std::cout << "mode  bias  spread  P(claim true)  mean |L_needed|      events\n";
+    for (const SweepCell& c : cells) {
+        std::cout << std::setw(4) << static_cast<int>(c.mode) << std::fixed << std::setprecision(2) << std::setw(6)
+                  << c.leftHandBias << std::setw(8) << c.angleSpread << std::setprecision(6) << std::setw(15)
+                  << c.hist.claimFraction() << std::setw(17) << c.hist.meanAbsL() << std::setw(12) << c.hist.events << "\n";
+    }
+    std::cerr << std::setprecision(3) << secs << " s\n";
+    return 0;
+}
+
+// Writes exactly the events a --batch run with the same settings samples.
+static int runRecord(const Options& opt) {
+    BatchConfig cfg = batchConfig(opt);
+
+    EventLogWriter log;
+    if (!log.open(opt.recordLog, opt.seed, opt.leftHandBias)) {
+        std::cerr << "cannot write " << opt.recordLog << "\n";
+        return 1;
+    }
+    for (std::uint64_t b = 0; b * kBatchBlock < cfg.events; ++b) {
+        forEachBlockSample(cfg, b, [&](const DecaySample& s) { log.append(recordFromSample(s, cfg.mode)); });
+    }
+    if (!log.close()) {
+        std::cerr << "error while writing " << opt.recordLog << "\n";
+        return 1;
+    }
+
+    std::cout << "wrote " << opt.events << " decays to " << opt.recordLog << " (seed " << opt.seed << ")\n";
+    return 0;
+}
+
+static const std::string TIP_NEUTRON_TITLE = "Neutron";
+static const std::string TIP_NEUTRON_BODY =
+    "This is the neutron before it breaks.\n\n"
+    "Think of it like:\n"
+    "  - One heavy ball\n"
+    "  - Sitting still\n"
+    "  - About to split\n\n"
+    "It does nothing else here except exist as the starting point.\n"
+    "It does not move because we are not teaching neutron motion,\n"
+    "only what comes out of it.";
+
+static const std::string TIP_PROTON_TITLE = "Proton";
+static const std::string TIP_PROTON_BODY =
+    "This is the proton after the break.\n\n"
+    "Think:\n"
+    "  - Neutron turns into a proton\n"
+    "  - Proton is heavy\n"
+    "  - It gets a kick back from what flew out\n\n"
+    "It recoils with the momentum the electron and anti-neutrino\n"
+    "leave unbalanced, opposite to their sum; the grey arrow shows it.\n"
+    "Being so heavy it moves far slower than them (sped up here so\n"
+    "you can see it drift).\n"
+    "Red means: the heavy leftover.";
+
+static const std::string TIP_ELECTRON_TITLE = "Electron (e-)";
+static const std::string TIP_ELECTRON_BODY =
+    "This is the electron.\n\n"
+    "Think:\n"
+    "  - A tiny piece that shoots out fast\n"
+    "  - Light\n"
+    "  - Easy to move\n\n"
+    "The yellow glow just helps your eyes track it.";
+
+static const std::string TIP_ANTINU_TITLE = "Anti-neutrino";
+static const std::string TIP_ANTINU_BODY =
+    "This is the anti-neutrino.\n\n"
+    "Think:\n"
+    "  - Even tinier than the electron\n"
+    "  - Almost invisible in real life\n"
+    "  - Flies off very fast\n\n"
+    "It usually goes roughly the opposite way from the electron.";
+
+static const std::string TIP_MOM_TITLE = "Momentum arrow";
+static const std::string TIP_MOM_BODY =
+    "This arrow means:\n"
+    "\"Which way is this thing moving?\"";
+
+static const std::string TIP_SPIN_TITLE = "Spin arrow";
+static const std::string TIP_SPIN_BODY =
+    "This arrow means:\n"
+    "\"Which way is this thing spinning?\"\n\n"
+    "This is the important one for the misconception.";
+
+static const std::string TIP_SWIRL_TITLE = "Swirl (extra angular momentum)";
+static const std::string TIP_SWIRL_BODY =
+    "This swirl means:\n"
+    "\"Something is missing if you only count spins.\" \n\n"
+    "When the spins do not add up, motion must carry the extra turning.\n"
+    "No swirl: spins alone work.\n"
+    "Swirl: spins alone do not work.";
+
+static const std::string& tipTitle(TipId id) {
+    static const std::string* const titles[] = {&TIP_NEUTRON_TITLE, &TIP_PROTON_TITLE, &TIP_ELECTRON_TITLE, &TIP_ANTINU_TITLE,
+                                                &TIP_MOM_TITLE,     &TIP_SPIN_TITLE,   &TIP_SWIRL_TITLE};
+    return *titles[static_cast<int>(id)];
+}
+
+static const std::string& tipBody(TipId id) {
+    static const std::string* const bodies[] = {&TIP_NEUTRON_BODY, &TIP_PROTON_BODY, &TIP_ELECTRON_BODY, &TIP_ANTINU_BODY,
+                                                &TIP_MOM_BODY,     &TIP_SPIN_BODY,   &TIP_SWIRL_BODY};
+    return *bodies[static_cast<int>(id)];
+}
+
+// Tooltip text and background laid out once per TIP id, on first hover. The
+// strings never change, so later frames only move the box with the mouse.
+class TooltipCache {
+public:
+    void draw(RenderBackend& rt, const sf::Font& font, TipId id, sf::Vector2f mousePos) {
+        DrawTag tag(rt, DrawHelper::Tooltip);
+        if (font_ != &font) {
+            for (auto& e : entries_) e.reset();
+            font_ = &font;
+        }
+        auto& slot = entries_[static_cast<std::size_t>(id)];
+        if (!slot) slot.emplace(font, id);
+        Entry& e = *slot;
+
+        sf::Vector2f boxPos = mousePos + sf::Vector2f{16.f, 16.f};
+
+        // Keep inside window-ish bounds (simple clamp)
+        if (boxPos.x + e.size.x > 1080.f) boxPos.x = 1080.f - e.size.x;
+        if (boxPos.y + e.size.y > 680.f) boxPos.y = 680.f - e.size.y;
+        if (boxPos.x < 10.f) boxPos.x = 10.f;
+        if (boxPos.y < 10.f) boxPos.y = 10.f;
+
+        e.box.setPosition(boxPos);
+        e.title.setPosition(boxPos + sf::Vector2f{kPad, kPad});
+        e.body.setPosition(boxPos + sf::Vector2f{kPad, kPad * 2.f + e.titleHeight});
+
+        rt.drawShape(e.box);
+        rt.drawText(e.title);
+        rt.drawText(e.body);
+    }
+
+private:
+    static constexpr float kPad = 10.f;
+
+    struct Entry {
+        sf::Text title;
+        sf::Text body;
+        sf::RectangleShape box;
+        sf::Vector2f size;
+        float titleHeight = 0.f;
+
+        Entry(const sf::Font& font, TipId id) : title(font), body(font) {
+            title.setCharacterSize(16);
+            title.setFillColor(sf::Color(240, 240, 240));
+            title.setString(tipTitle(id));
+
+            body.setCharacterSize(15);
+            body.setFillColor(sf::Color(220, 220, 220));
+            body.setString(tipBody(id));
+
+            auto bt = title.getLocalBounds();
+            auto bb = body.getLocalBounds();
+            titleHeight = bt.size.y;
+            size = {std::max(bt.size.x, bb.size.x) + kPad * 2.f, (bt.size.y + bb.size.y) + kPad * 3.f};
+
+            box.setSize(size);
+            box.setFillColor(sf::Color(10, 12, 16, 230));
+            box.setOutlineThickness(1.f);
+            box.setOutlineColor(sf::Color(90, 100, 125, 200));
+        }
+    };
+
+    const sf::Font* font_ = nullptr;
+    std::array<std::optional<Entry>, static_cast<std::size_t>(TipId::Count)> entries_;
+};
+
+// Vertex buffers of the cloud view, one draw call each.
+struct CloudMesh {
+    std::vector<sf::Vertex> glow, trails, cores, arrows;
+};
+
+// Everything the interactive view shows, so a frame can be stepped and drawn
+// the same way with a window or without one.
+struct Viz {
+    sf::FloatRect arena{sf::Vector2f{60.f, 60.f}, sf::Vector2f{980.f, 580.f}};
+    sf::Vector2f origin{arena.position.x + 140.f, arena.position.y + arena.size.y * 0.5f};
 
     Mode mode = Mode::SpinOnly;
     bool paused = false;
     bool stepOnce = false;
     bool showHelp = true;
+    bool showStats = true;
+    bool showDraws = false;
 
     float leftHandBias = 0.85f;
-    DecayEvent current = makeEvent(rng, origin, leftHandBias, mode);
-
-    sf::Clock clock;
+    float polarization = 1.f; // PageUp/PageDown
+    std::uint8_t channel = 0; // C cycles through decayChannels()
+    std::mt19937 rng;
+
+    // In replay the recorded run fixes mode and bias; new decays come from the log.
+    const MappedEventLog* replay = nullptr;
+    std::uint64_t replayIndex = 0;
+
+    LiveStats* live = nullptr;
+
+    // Population mode: new decays are the population's, shown as each one
+    // finishes playing; `released` tallies every decay at the current settings.
+    Population* population = nullptr;
+    DecayHistograms released;
+    DecaySample lastReleased;
+    bool haveReleased = false;
+    Mode releasedMode = Mode::SpinOnly;
+    float releasedBias = 0.f;
+    float releasedPolarization = 1.f;
+    std::uint8_t releasedChannel = 0;
+
+    // Cloud view (V): cloudSize decays at once, refilled when the settings
+    // they were drawn with change. `detail` decides how much of them is drawn;
+    // the mesh buffers are reused from frame to frame.
+    bool showCloud = false;
+    std::size_t cloudSize = DecayCloud::kDefaultSize;
+    DecayCloud cloud;
+    Mode cloudMode = Mode::SpinOnly;
+    float cloudBias = 0.f;
+    float cloudPolarization = 1.f;
+    std::uint8_t cloudChannel = 0;
+    DetailGovernor detail{kCloudDetailLevels};
+    CloudMesh cloudMesh;
+
+    // Draw counts of the previous frame for the profiler overlay, if kept.
+    const RenderStats* drawStats = nullptr;
+
+    TooltipCache tips;
+
+    // Charged lepton energies of every decay generated so far in this channel.
+    EnergyHistogram spectrum;
+
+    DecayEvent current;
     float t = 0.f;
+};
 
-    while (window.isOpen()) {
-        float dtReal = clock.restart().asSeconds();
-        float dt = dtReal;
+static DecayEvent showRecorded(Viz& v, std::uint64_t i) {
+    v.replayIndex = i % v.replay->count();
+    const EventRecord& r = v.replay->record(v.replayIndex);
+    v.mode = modeFromRecord(r);
+    return eventFromSample(sampleFromRecord(r, v.replay->channel(r)), v.origin);
+}
 
-        if (paused) {
-            dt = 0.f;
-            if (stepOnce) {
-                dt = 1.f / 60.f;
-                stepOnce = false;
-            }
+// A new random decay; its electron energy goes into the spectrum.
+static DecayEvent freshEventAt(Viz& v, sf::Vector2f origin) {
+    DecayEvent ev = makeEvent(v.rng, origin, v.leftHandBias, v.mode, v.polarization, v.channel);
+    v.spectrum.add(ev.electronT);
+    return ev;
+}
+
+static DecayEvent freshEvent(Viz& v) { return freshEventAt(v, v.origin); }
+
+static DecayEvent nextEvent(Viz& v) {
+    if (v.replay) return showRecorded(v, v.replayIndex + 1);
+    return freshEvent(v);
+}
+
+// Switches channel; the energy histogram starts over on the new endpoint.
+static void setChannel(Viz& v, std::uint8_t channel) {
+    v.channel = channel;
+    v.spectrum = EnergyHistogram{};
+    v.spectrum.endpoint = decayChannels().q[channel];
+}
+
+// Brings the cloud to cloudSize decays at the current settings; refill
+// replaces the ones it already has too.
+static void fillCloud(Viz& v, bool refill) {
+    auto spawn = [&v](sf::Vector2f origin) { return freshEventAt(v, origin); };
+    if (refill) v.cloud.refill(v.rng, v.arena, spawn);
+    v.cloud.resize(v.cloudSize, v.rng, v.arena, spawn);
+    v.cloudMode = v.mode;
+    v.cloudBias = v.leftHandBias;
+    v.cloudPolarization = v.polarization;
+    v.cloudChannel = v.channel;
+}
+
+static void setCloud(Viz& v, bool on) {
+    v.showCloud = on;
+    if (on) {
+        fillCloud(v, false);
+    } else {
+        v.cloud.clear();
+    }
+}
+
+static void initViz(Viz& v, const Options& opt, const MappedEventLog* replay, LiveStats* live) {
+    v.rng = seededRng(opt.seed);
+    v.polarization = opt.polarization;
+    setChannel(v, opt.channels.first());
+    v.replay = replay;
+    v.live = live;
+    if (v.replay) {
+        v.leftHandBias = v.replay->header().leftHandBias;
+        v.current = showRecorded(v, opt.replayStart);
+    } else {
+        v.current = freshEvent(v);
+    }
+    if (v.live) v.live->start(v.mode, v.leftHandBias, v.polarization, v.channel);
+
+    if (opt.cloud > 0) {
+        v.cloudSize = static_cast<std::size_t>(opt.cloud);
+        setCloud(v, true);
+    }
+    v.detail.pin(opt.cloudDetail);
+}
+
+static void handleKey(Viz& v, sf::Keyboard::Key code) {
+    // View controls (also available in replay)
+    if (code == sf::Keyboard::Key::P) {
+        v.paused = !v.paused;
+    } else if (code == sf::Keyboard::Key::N) {
+        if (v.paused) v.stepOnce = true;
+    } else if (code == sf::Keyboard::Key::H) {
+        v.showHelp = !v.showHelp;
+    } else if (code == sf::Keyboard::Key::S) {
+        v.showStats = !v.showStats;
+    } else if (code == sf::Keyboard::Key::D) {
+        v.showDraws = !v.showDraws;
+    }
+
+    // Replay: Space/Right step forward through the log, Left steps back
+    if (v.replay) {
+        if (code == sf::Keyboard::Key::Space || code == sf::Keyboard::Key::Right) {
+            v.current = nextEvent(v);
+        } else if (code == sf::Keyboard::Key::Left) {
+            v.current = showRecorded(v, v.replayIndex + v.replay->count() - 1);
         }
+        return;
+    }
 
-        t += dt;
+    // Mode switches
+    if (code == sf::Keyboard::Key::Num1) {
+        v.mode = Mode::SpinOnly;
+        v.current = freshEvent(v);
+    } else if (code == sf::Keyboard::Key::Num2) {
+        v.mode = Mode::SpinAndMotion;
+        v.current = freshEvent(v);
+    } else if (code == sf::Keyboard::Key::Num3) {
+        v.mode = Mode::FullConservation;
+        v.current = freshEvent(v);
+    }
 
-        while (auto ev = window.pollEvent()) {
-            if (ev->is<sf::Event::Closed>()) window.close();
+    // Controls
+    if (code == sf::Keyboard::Key::Space) {
+        v.current = freshEvent(v);
+    } else if (code == sf::Keyboard::Key::Up) {
+        v.leftHandBias = std::min(0.99f, v.leftHandBias + 0.02f);
+        v.current = freshEvent(v);
+    } else if (code == sf::Keyboard::Key::Down) {
+        v.leftHandBias = std::max(0.01f, v.leftHandBias - 0.02f);
+        v.current = freshEvent(v);
+    } else if (code == sf::Keyboard::Key::PageUp) {
+        v.polarization = std::min(1.f, v.polarization + 0.05f);
+        v.current = freshEvent(v);
+    } else if (code == sf::Keyboard::Key::PageDown) {
+        v.polarization = std::max(0.f, v.polarization - 0.05f);
+        v.current = freshEvent(v);
+    } else if (code == sf::Keyboard::Key::C) {
+        setChannel(v, static_cast<std::uint8_t>((v.channel + 1) % decayChannels().count));
+        v.current = freshEvent(v);
+    }
 
-            if (const auto* kp = ev->getIf<sf::Event::KeyPressed>()) {
-                // Mode switches
-                if (kp->code == sf::Keyboard::Key::Num1) {
-                    mode = Mode::SpinOnly;
-                    current = makeEvent(rng, origin, leftHandBias, mode);
-                } else if (kp->code == sf::Keyboard::Key::Num2) {
-                    mode = Mode::SpinAndMotion;
-                    current = makeEvent(rng, origin, leftHandBias, mode);
-                } else if (kp->code == sf::Keyboard::Key::Num3) {
-                    mode = Mode::FullConservation;
-                    current = makeEvent(rng, origin, leftHandBias, mode);
-                }
+    // Cloud view: V toggles, [ ] halve and double the decays (and let the
+    // governor start over from full detail for the new load), L steps the
+    // detail from automatic through each fixed level. Space draws a new cloud.
+    // A population shows its own decays, so it has no cloud.
+    if (v.population) return;
+    if (code == sf::Keyboard::Key::V) {
+        setCloud(v, !v.showCloud);
+    } else if (code == sf::Keyboard::Key::L) {
+        int next = v.detail.automatic() ? 0 : v.detail.level() + 1;
+        v.detail.pin(next < kCloudDetailLevels ? next : -1);
+    } else if (v.showCloud && code == sf::Keyboard::Key::LBracket) {
+        v.cloudSize = std::max(DecayCloud::kMinSize, v.cloudSize / 2);
+        fillCloud(v, false);
+        v.detail.reset();
+    } else if (v.showCloud && code == sf::Keyboard::Key::RBracket) {
+        v.cloudSize = std::min(DecayCloud::kMaxSize, v.cloudSize * 2);
+        fillCloud(v, false);
+        v.detail.reset();
+    } else if (v.showCloud && code == sf::Keyboard::Key::Space) {
+        fillCloud(v, true);
+    }
+}
 
-                // Controls
-                if (kp->code == sf::Keyboard::Key::Space) {
-                    current = makeEvent(rng, origin, leftHandBias, mode);
-                } else if (kp->code == sf::Keyboard::Key::Up) {
-                    leftHandBias = std::min(0.99f, leftHandBias + 0.02f);
-                    current = makeEvent(rng, origin, leftHandBias, mode);
-                } else if (kp->code == sf::Keyboard::Key::Down) {
-                    leftHandBias = std::max(0.01f, leftHandBias - 0.02f);
-                    current = makeEvent(rng, origin, leftHandBias, mode);
-                } else if (kp->code == sf::Keyboard::Key::P) {
-                    paused = !paused;
-                } else if (kp->code == sf::Keyboard::Key::N) {
-                    if (paused) stepOnce = true;
-                } else if (kp->code == sf::Keyboard::Key::H) {
-                    showHelp = !showHelp;
-                }
-            }
+// FNV-1a over the state a replay must reproduce, printed after recording and
+// replaying a session so the two can be compared.
+static std::uint64_t vizChecksum(const Viz& v) {
+    std::uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void* p, std::size_t n) {
+        const unsigned char* b = static_cast<const unsigned char*>(p);
+        for (std::size_t i = 0; i < n; ++i) h = (h ^ b[i]) * 1099511628211ull;
+    };
+    auto mixParticle = [&](const Particle& p) {
+        mix(&p.pos, sizeof(p.pos));
+        mix(&p.vel, sizeof(p.vel));
+        mix(&p.spinDir, sizeof(p.spinDir));
+    };
+
+    int flags = static_cast<int>(v.mode) | (v.paused ? 16 : 0) | (v.showHelp ? 32 : 0);
+    mix(&flags, sizeof(flags));
+    mix(&v.leftHandBias, sizeof(v.leftHandBias));
+    mix(&v.polarization, sizeof(v.polarization));
+    mix(&v.channel, sizeof(v.channel));
+    mix(&v.t, sizeof(v.t));
+    mix(&v.current.timeAlive, sizeof(v.current.timeAlive));
+    if (v.population) {
+        std::uint64_t left = v.population->survivors();
+        mix(&left, sizeof(left));
+        mix(&v.released.claimTrue, sizeof(v.released.claimTrue));
+    }
+    mixParticle(v.current.electron);
+    mixParticle(v.current.antinu);
+    for (const CloudDecay& d : v.cloud.decays()) {
+        mix(&d.charged.pos, sizeof(d.charged.pos));
+        mix(&d.neutral.pos, sizeof(d.neutral.pos));
+        mix(&d.age, sizeof(d.age));
+    }
+    mix(&v.current.protonPos, sizeof(v.current.protonPos));
+    std::mt19937 next = v.rng;
+    std::uint32_t r = next();
+    mix(&r, sizeof(r));
+    return h;
+}
+
+// Simulation time for this frame: dtReal, or 0 while paused (one 1/60 s step after N).
+static float frameDt(Viz& v, float dtReal) {
+    float dt = dtReal;
+
+    if (v.paused) {
+        dt = 0.f;
+        if (v.stepOnce) {
+            dt = 1.f / 60.f;
+            v.stepOnce = false;
         }
+    }
 
-        Tooltip tip;
-        sf::Vector2f mouse = window.mapPixelToCoords(sf::Mouse::getPosition(window));
+    v.t += dt;
+    return dt;
+}
 
-        struct Seg { sf::Vector2f a; sf::Vector2f b; int kind; }; // kind 0 momentum, 1 spin
-        std::vector<Seg> segs;
+static void advanceViz(Viz& v, float dt) {
+    // Background sampler follows whatever the view is showing
+    if (v.live) v.live->setParams(v.mode, v.leftHandBias, v.polarization, v.channel);
+
+    // Every neutron decaying in this step is sampled like makeEvent() does,
+    // minus the render state only the one on screen needs.
+    if (v.population) {
+        if (v.releasedMode != v.mode || v.releasedBias != v.leftHandBias || v.releasedPolarization != v.polarization ||
+            v.releasedChannel != v.channel) {
+            v.released = DecayHistograms{};
+            v.releasedMode = v.mode;
+            v.releasedBias = v.leftHandBias;
+            v.releasedPolarization = v.polarization;
+            v.releasedChannel = v.channel;
+        }
+        v.population->advance(dt, [&] {
+            v.lastReleased = sampleThreeBody(v.rng, v.leftHandBias, v.mode, kAngleSpread, v.polarization, v.channel);
+            v.released.add(v.lastReleased);
+            v.spectrum.add(v.lastReleased.electronT);
+            v.haveReleased = true;
+        });
+    }
 
-        // Update timing: only advance and auto-respawn when not paused
-        if (dt > 0.f) {
-            current.timeAlive += dt;
-            if (current.timeAlive >= current.duration) {
-                current = makeEvent(rng, origin, leftHandBias, mode);
+    // The cloud replaces the single decay; it starts over when the settings change.
+    if (v.showCloud) {
+        if (v.cloudMode != v.mode || v.cloudBias != v.leftHandBias || v.cloudPolarization != v.polarization ||
+            v.cloudChannel != v.channel) {
+            fillCloud(v, true);
+        }
+        v.cloud.advance(dt, v.rng, v.arena, [&v](sf::Vector2f origin) { return freshEventAt(v, origin); });
+        return;
+    }
+
+    // Update timing: only advance and auto-respawn when not paused
+    if (dt > 0.f) {
+        v.current.timeAlive += dt;
+        if (v.current.timeAlive >= v.current.duration) {
+            if (!v.population) {
+                v.current = nextEvent(v);
+            } else if (v.haveReleased) {
+                // The latest decay replaces the finished one; with none since, it keeps flying.
+                v.current = eventFromSample(v.lastReleased, v.origin);
+                v.haveReleased = false;
             }
         }
+    }
 
-        auto stepParticle = [&](Particle& p) {
-            if (dt <= 0.f) return;
+    auto stepParticle = [&](Particle& p) {
+        if (dt <= 0.f) return;
 
-            p.pos += p.vel * dt;
+        p.pos += p.vel * dt;
 
-            p.trailTimer += dt;
-            if (p.trailTimer >= 0.02f) {
-                p.trailTimer = 0.f;
-                p.trail.push_back(p.pos);
-                if (p.trail.size() > 70) p.trail.erase(p.trail.begin());
-            }
+        p.trailTimer += dt;
+        if (p.trailTimer >= 0.02f) {
+            p.trailTimer = 0.f;
+            p.trail.push_back(p.pos);
+            if (p.trail.size() > 70) p.trail.erase(p.trail.begin());
+        }
 
-            float left = arena.position.x;
-            float top = arena.position.y;
-            float right = arena.position.x + arena.size.x;
-            float bottom = arena.position.y + arena.size.y;
+        float left = v.arena.position.x;
+        float top = v.arena.position.y;
+        float right = v.arena.position.x + v.arena.size.x;
+        float bottom = v.arena.position.y + v.arena.size.y;
 
-            if (p.pos.x < left + p.radius) { p.pos.x = left + p.radius; p.vel.x *= -1.f; }
-            if (p.pos.x > right - p.radius) { p.pos.x = right - p.radius; p.vel.x *= -1.f; }
-            if (p.pos.y < top + p.radius) { p.pos.y = top + p.radius; p.vel.y *= -1.f; }
-            if (p.pos.y > bottom - p.radius) { p.pos.y = bottom - p.radius; p.vel.y *= -1.f; }
+        if (p.pos.x < left + p.radius) { p.pos.x = left + p.radius; p.vel.x *= -1.f; }
+        if (p.pos.x > right - p.radius) { p.pos.x = right - p.radius; p.vel.x *= -1.f; }
+        if (p.pos.y < top + p.radius) { p.pos.y = top + p.radius; p.vel.y *= -1.f; }
+        if (p.pos.y > bottom - p.radius) { p.pos.y = bottom - p.radius; p.vel.y *= -1.f; }
 
-            p.spinDir = vnorm(p.spinDir);
-        };
+        p.spinDir = vnorm(p.spinDir);
+    };
 
-        stepParticle(current.electron);
-        stepParticle(current.antinu);
+    stepParticle(v.current.electron);
+    stepParticle(v.current.antinu);
+    v.current.protonPos += v.current.protonVel * dt;
+}
+
+// Cloud view helpers: each appends one shape to a vertex list that is drawn
+// with a single call, instead of one or more calls per shape. Lists keep
+// their capacity, so this is plain stores once the first frames have run.
+static sf::Vertex* appendVertices(std::vector<sf::Vertex>& out, std::size_t n) {
+    out.resize(out.size() + n);
+    return out.data() + out.size() - n;
+}
+
+// Triangle fan around c as a triangle list; segments divides 12.
+static void appendDisc(std::vector<sf::Vertex>& out, sf::Vector2f c, float r, sf::Color col, int segments) {
+    constexpr int kMaxSegments = 12;
+    static const std::array<sf::Vector2f, kMaxSegments + 1> unit = [] {
+        std::array<sf::Vector2f, kMaxSegments + 1> u{};
+        for (int i = 0; i <= kMaxSegments; ++i) {
+            float a = 2.f * 3.1415926f * static_cast<float>(i) / kMaxSegments;
+            u[static_cast<std::size_t>(i)] = sf::Vector2f{std::cos(a), std::sin(a)};
+        }
+        return u;
+    }();
+    const int stride = kMaxSegments / segments;
+    sf::Vertex* w = appendVertices(out, static_cast<std::size_t>(3 * segments));
+    for (int i = 0; i < kMaxSegments; i += stride) {
+        *w++ = sf::Vertex{c, col};
+        *w++ = sf::Vertex{c + unit[static_cast<std::size_t>(i)] * r, col};
+        *w++ = sf::Vertex{c + unit[static_cast<std::size_t>(i + stride)] * r, col};
+    }
+}
 
-        // Evaluate the misconception claim
-        // Claim: "the neutrino spins opposite the electron"
-        // In this viz: use anti-nu. Opposite means spin vectors point opposite (dot < 0).
-        float spinDot = vdot(vnorm(current.electron.spinDir), vnorm(current.antinu.spinDir));
-        bool claimLooksTrue = (spinDot < -0.2f);
+static void appendSquare(std::vector<sf::Vertex>& out, sf::Vector2f c, float r, sf::Color col) {
+    sf::Vertex* w = appendVertices(out, 6);
+    w[0] = w[3] = sf::Vertex{c + sf::Vector2f{-r, -r}, col};
+    w[1] = sf::Vertex{c + sf::Vector2f{r, -r}, col};
+    w[2] = w[4] = sf::Vertex{c + sf::Vector2f{r, r}, col};
+    w[5] = sf::Vertex{c + sf::Vector2f{-r, r}, col};
+}
 
-        // Helicity (only meaningful in modes 2 and 3)
-        int hE = helicitySign(vnorm(current.electron.spinDir), vnorm(current.electron.vel));
-        int hN = helicitySign(vnorm(current.antinu.spinDir), vnorm(current.antinu.vel));
+// Same lines as drawArrow().
+static void appendArrow(std::vector<sf::Vertex>& out, sf::Vector2f from, sf::Vector2f dirUnit, float L, sf::Color col,
+                        float head) {
+    sf::Vector2f to = from + dirUnit * L;
+    sf::Vector2f p = vperp(dirUnit);
+    sf::Vertex* w = appendVertices(out, 6);
+    w[0] = sf::Vertex{from, col};
+    w[1] = w[2] = w[4] = sf::Vertex{to, col};
+    w[3] = sf::Vertex{to - dirUnit * head + p * (head * 0.55f), col};
+    w[5] = sf::Vertex{to - dirUnit * head - p * (head * 0.55f), col};
+}
 
-        // Render
-        window.clear(sf::Color(12, 14, 18));
+// Fading trail like drawTrail(), as separate segments so every trail goes into
+// the same list.
+static void appendTrail(std::vector<sf::Vertex>& out, const CloudLepton& p, sf::Color col) {
+    if (p.trailCount < 2) return;
+    sf::Vertex* w = appendVertices(out, static_cast<std::size_t>(2 * (p.trailCount - 1)));
+    for (int i = 1; i < p.trailCount; ++i) {
+        sf::Color a = col, b = col;
+        a.a = static_cast<std::uint8_t>(30 + 110 * (i - 1) / (CloudLepton::kTrail - 1));
+        b.a = static_cast<std::uint8_t>(30 + 110 * i / (CloudLepton::kTrail - 1));
+        *w++ = sf::Vertex{p.trailPoint(i - 1), a};
+        *w++ = sf::Vertex{p.trailPoint(i), b};
+    }
+}
 
-        sf::RectangleShape box(arena.size);
-        box.setPosition(arena.position);
-        box.setFillColor(sf::Color(16, 18, 24));
-        box.setOutlineThickness(2.f);
-        box.setOutlineColor(sf::Color(70, 80, 95));
-        window.draw(box);
+static void drawMesh(RenderBackend& gfx, DrawHelper helper, const std::vector<sf::Vertex>& v, sf::PrimitiveType type) {
+    if (v.empty()) return;
+    DrawTag tag(gfx, helper);
+    gfx.drawVertices(v.data(), v.size(), type);
+}
 
-        // neutron and proton
-        drawGlowCircle(window, origin, 18.f, sf::Color(160, 210, 255));
-        sf::Vector2f protonPos(origin.x + 40.f, origin.y);
-        drawGlowCircle(window, protonPos, 14.f, sf::Color(255, 120, 150));
-        if (hasFont) {
-            drawLabel(window, font, origin + sf::Vector2f{0.f, -30.f}, "Neutron");
-            drawLabel(window, font, protonPos + sf::Vector2f{0.f, -26.f}, "Proton");
+// Every decay of the cloud at the governor's detail level. Glow rings, labels,
+// trails and full arrows go in that order as the level rises; what is left is a
+// dot per body and a tick along each lepton spin, fading from the lepton
+// outwards, so the spread of spin directions still shows with tens of
+// thousands of decays. In Mode 3 the daughter is green when the spins balance
+// (L_needed = 0) and red when they do not, in place of the swirl.
+static void drawCloudView(RenderBackend& gfx, Viz& v, const sf::Font& font, bool hasFont) {
+    const sf::FloatRect& arena = v.arena;
+    const Mode mode = v.mode;
+    const DecayChannels& channels = decayChannels();
+    const std::vector<CloudDecay>& decays = v.cloud.decays();
+    const CloudDetail detail = static_cast<CloudDetail>(v.detail.level());
+    const bool glow = detail < CloudDetail::NoGlow;
+    const bool labels = hasFont && detail < CloudDetail::NoLabels;
+    const bool trails = detail < CloudDetail::NoTrails;
+    const bool arrows = detail < CloudDetail::SpinTicks;
+
+    TraceScope phase("background");
+    gfx.clear(sf::Color(12, 14, 18));
+    sf::RectangleShape box(arena.size);
+    box.setPosition(arena.position);
+    box.setFillColor(sf::Color(16, 18, 24));
+    box.setOutlineThickness(2.f);
+    box.setOutlineColor(sf::Color(70, 80, 95));
+    gfx.drawShape(box);
+
+    phase.next("particles");
+    CloudMesh& m = v.cloudMesh;
+    m.glow.clear();
+    m.trails.clear();
+    m.cores.clear();
+    m.arrows.clear();
+    std::uint64_t claims = 0, unbalanced = 0;
+    for (const CloudDecay& d : decays) {
+        const std::size_t ch = d.channel;
+        const sf::Color colors[3] = {
+            mode != Mode::FullConservation ? sf::Color(255, 120, 150)
+            : d.L_needed == 0              ? sf::Color(120, 220, 140)
+                                           : sf::Color(230, 120, 120),
+            channels.chargedColor[ch], channels.neutralColor[ch]};
+        const sf::Vector2f pos[3] = {d.daughterPos, d.charged.pos, d.neutral.pos};
+        const float radius[3] = {3.5f, DecayCloud::kRadius, 2.5f};
+        claims += d.claimTrue ? 1u : 0u;
+        unbalanced += d.L_needed != 0 ? 1u : 0u;
+
+        for (int b = 0; b < 3; ++b) {
+            if (glow) {
+                for (int i = 3; i >= 1; --i) {
+                    sf::Color c = colors[b];
+                    c.a = static_cast<std::uint8_t>(24 * i);
+                    appendDisc(m.glow, pos[b], radius[b] + 2.f * i, c, 12);
+                }
+            }
+            if (arrows) {
+                appendDisc(m.cores, pos[b], radius[b], colors[b], 6);
+            } else {
+                appendSquare(m.cores, pos[b], radius[b] * 0.8f, colors[b]);
+            }
         }
 
+        for (const CloudLepton* p : {&d.charged, &d.neutral}) {
+            const sf::Color col = p == &d.charged ? colors[1] : colors[2];
+            if (trails) appendTrail(m.trails, *p, col);
+            if (!arrows) {
+                sf::Color tip(245, 245, 245, 255), base = tip;
+                base.a = 90;
+                sf::Vertex* w = appendVertices(m.arrows, 2);
+                w[0] = sf::Vertex{p->pos, base};
+                w[1] = sf::Vertex{p->pos + p->spin * 14.f, tip};
+            } else if (mode == Mode::SpinOnly) {
+                appendArrow(m.arrows, p->pos, p->spin, 20.f, sf::Color(230, 230, 230, 220), 5.f);
+            } else {
+                sf::Vector2f momDir = vnorm(p->vel);
+                if (vlen(p->vel) > 0.f) appendArrow(m.arrows, p->pos, momDir, 22.f, sf::Color(150, 150, 150, 220), 5.f);
+                appendArrow(m.arrows, p->pos + vperp(momDir) * 4.f, p->spin, 18.f, sf::Color(235, 235, 235, 220), 5.f);
+            }
+        }
+    }
+    drawMesh(gfx, DrawHelper::Glow, m.glow, sf::PrimitiveType::Triangles);
+    drawMesh(gfx, DrawHelper::Trail, m.trails, sf::PrimitiveType::Lines);
+    drawMesh(gfx, DrawHelper::Scene, m.cores, sf::PrimitiveType::Triangles);
 
-        // Orbital placeholder only in Mode 3
-        if (mode == Mode::FullConservation) {
-            drawOrbitalSwirl(window, origin, current.L_needed, t);
+    phase.next("vectors");
+    drawMesh(gfx, DrawHelper::Arrow, m.arrows, sf::PrimitiveType::Lines);
+
+    if (labels) {
+        for (const CloudDecay& d : decays) {
+            drawLabel(gfx, font, d.charged.pos + sf::Vector2f{0.f, -12.f}, channels.chargedLabel[d.channel]);
+            drawLabel(gfx, font, d.neutral.pos + sf::Vector2f{0.f, -12.f}, channels.neutralLabel[d.channel]);
         }
+    }
 
-        // Trails
-        drawTrail(window, current.electron);
-        drawTrail(window, current.antinu);
+    phase.next("HUD");
+    if (!hasFont) return;
+    DrawTag hud(gfx, DrawHelper::Hud);
+
+    sf::Vector2f panelPos{arena.position.x + 10.f, arena.position.y + 10.f};
+    gfx.drawShape(hudPanel(panelPos, sf::Vector2f{arena.size.x - 20.f, 140.f}));
+
+    const double n = decays.empty() ? 1.0 : static_cast<double>(decays.size());
+    std::ostringstream ss;
+    ss << modeTitle(mode) << (v.paused ? "   [PAUSED]" : "") << "   " << channels.title[v.channel] << "\n";
+    ss << "Keys: V single decay   [ ] fewer/more decays   L detail   Space new cloud   1 2 3 modes   C channel\n";
+    ss << "      Up Down bias   PgUp PgDn polarization   P pause   N step   H help   S stats   D draws\n";
+    ss << "Cloud of " << decays.size() << " decays, detail: " << cloudDetailName(detail)
+       << (v.detail.automatic() ? " (auto)" : " (fixed)") << std::fixed << std::setprecision(1) << "   update+draw "
+       << v.detail.workSeconds() * 1e3 << " ms, frame " << v.detail.frameSeconds() * 1e3 << " ms of "
+       << v.detail.budget() * 1e3 << " ms\n";
+    ss << "Claim \"the neutrino spins opposite the electron\" looks true for " << 100.0 * claims / n
+       << "% of these decays\n";
+    if (mode == Mode::FullConservation) {
+        ss << "Spins alone do NOT balance for " << 100.0 * unbalanced / n << "% of them (red daughters, L_needed != 0)\n";
+    } else {
+        ss << "What you are seeing: the spread of spin directions over the whole sample, not one decay.\n";
+    }
 
-        // Particles
-        drawGlowCircle(window, current.electron.pos, current.electron.radius, current.electron.color);
-        drawGlowCircle(window, current.antinu.pos, current.antinu.radius, current.antinu.color);
-        if (hasFont) {
-            drawLabel(window, font, current.electron.pos + sf::Vector2f{0.f, -22.f}, "Electron");
-            drawLabel(window, font, current.antinu.pos + sf::Vector2f{0.f, -22.f}, "Anti-neutrino");
+    sf::Text text(font);
+    text.setCharacterSize(16);
+    text.setFillColor(sf::Color(230, 230, 230));
+    text.setPosition(panelPos + sf::Vector2f{10.f, 8.f});
+    text.setString(ss.str());
+    gfx.drawText(text);
+
+    if (v.showHelp) {
+        if (const BetaSpectrum* shape = channels.spectrum[v.channel]) {
+            sf::Vector2f p6{arena.position.x + 10.f, arena.position.y + arena.size.y - 260.f};
+            drawSpectrumPanel(gfx, font, p6, v.spectrum, *shape, channels.chargedLabel[v.channel]);
         }
+    }
+    if (v.showStats && v.live) {
+        sf::Vector2f p3{arena.position.x + arena.size.x - 290.f, arena.position.y + 160.f};
+        drawStatsPanel(gfx, font, p3, v.live->latest());
+    }
+    if (v.showDraws && v.drawStats) {
+        sf::Vector2f p4{arena.position.x + 10.f, arena.position.y + 160.f};
+        drawProfilerPanel(gfx, font, p4, *v.drawStats);
+    }
+}
 
+// One frame of the scene, HUD and tooltip for the given mouse position.
+static void drawViz(RenderBackend& gfx, Viz& v, const sf::Font& font, bool hasFont, sf::Vector2f mouse) {
+    const sf::FloatRect& arena = v.arena;
+    const sf::Vector2f origin = v.origin;
+    const Mode mode = v.mode;
+    const bool paused = v.paused;
+    const bool showHelp = v.showHelp;
+    const bool showStats = v.showStats;
+    const bool showDraws = v.showDraws;
+    const float leftHandBias = v.leftHandBias;
+    const float t = v.t;
+    const DecayEvent& current = v.current;
+    const DecayChannels& channels = decayChannels();
+    const std::size_t ch = current.channel;
+
+    if (v.showCloud) {
+        drawCloudView(gfx, v, font, hasFont);
+        return;
+    }
 
-        auto drawVectors = [&](const Particle& p) {
-            sf::Vector2f momDir = vnorm(p.vel);
-            sf::Vector2f spinDir = vnorm(p.spinDir);
+    Tooltip tip;
+
+    struct Seg { sf::Vector2f a; sf::Vector2f b; int kind; }; // kind 0 momentum, 1 spin
+    std::vector<Seg> segs;
+
+    // Evaluate the misconception claim
+    // Claim: "the neutrino spins opposite the electron"
+    // In this viz: use anti-nu. Opposite means spin vectors point opposite (dot < 0).
+    float spinDot = vdot(vnorm(current.electron.spinDir), vnorm(current.antinu.spinDir));
+    bool claimLooksTrue = (spinDot < -0.2f);
+
+    // Helicity (only meaningful in modes 2 and 3)
+    int hE = helicitySign(vnorm(current.electron.spinDir), vnorm(current.electron.vel));
+    int hN = helicitySign(vnorm(current.antinu.spinDir), vnorm(current.antinu.vel));
+
+    // Render
+    TraceScope phase("background");
+    gfx.clear(sf::Color(12, 14, 18));
+
+    sf::RectangleShape box(arena.size);
+    box.setPosition(arena.position);
+    box.setFillColor(sf::Color(16, 18, 24));
+    box.setOutlineThickness(2.f);
+    box.setOutlineColor(sf::Color(70, 80, 95));
+    gfx.drawShape(box);
+
+    // neutron and proton
+    drawGlowCircle(gfx, origin, 18.f, sf::Color(160, 210, 255));
+    const sf::Vector2f protonPos = current.protonPos;
+    drawGlowCircle(gfx, protonPos, 14.f, sf::Color(255, 120, 150));
+    if (hasFont) {
+        drawLabel(gfx, font, origin + sf::Vector2f{0.f, -30.f}, channels.parentLabel[ch]);
+        drawLabel(gfx, font, protonPos + sf::Vector2f{0.f, -26.f}, channels.daughterLabel[ch]);
+    }
 
-            if (mode == Mode::SpinOnly) {
-                sf::Vector2f a = p.pos;
-                sf::Vector2f b = p.pos + spinDir * 55.f;
-                drawArrow(window, a, spinDir, 55.f, sf::Color(230, 230, 230, 220));
-                segs.push_back(Seg{a, b, 1});
-                return;
-            }
 
-            // momentum
-            {
-                sf::Vector2f a = p.pos;
-                sf::Vector2f b = p.pos + momDir * 60.f;
-                drawArrow(window, a, momDir, 60.f, sf::Color(150, 150, 150, 220));
-                segs.push_back(Seg{a, b, 0});
-            }
+    // Orbital placeholder only in Mode 3
+    if (mode == Mode::FullConservation) {
+        drawOrbitalSwirl(gfx, origin, current.L_needed, t);
+    }
 
-            // spin
-            {
-                sf::Vector2f off = vperp(momDir) * 10.f;
-                sf::Vector2f a = p.pos + off;
-                sf::Vector2f b = a + spinDir * 48.f;
-                drawArrow(window, a, spinDir, 48.f, sf::Color(235, 235, 235, 220));
-                segs.push_back(Seg{a, b, 1});
-            }
-        };
+    // Trails
+    phase.next("trails");
+    drawTrail(gfx, current.electron);
+    drawTrail(gfx, current.antinu);
+
+    // Particles
+    phase.next("particles");
+    drawGlowCircle(gfx, current.electron.pos, current.electron.radius, current.electron.color);
+    drawGlowCircle(gfx, current.antinu.pos, current.antinu.radius, current.antinu.color);
+    if (hasFont) {
+        drawLabel(gfx, font, current.electron.pos + sf::Vector2f{0.f, -22.f}, channels.chargedLabel[ch]);
+        drawLabel(gfx, font, current.antinu.pos + sf::Vector2f{0.f, -22.f}, channels.neutralLabel[ch]);
+    }
 
-        drawVectors(current.electron);
-        drawVectors(current.antinu);
 
-        // HUD and teaching text
-        if (hasFont) {
-            // Top panel
-            sf::Vector2f panelPos{arena.position.x + 10.f, arena.position.y + 10.f};
-            sf::Vector2f panelSize{arena.size.x - 20.f, 140.f};
-            auto panel = hudPanel(panelPos, panelSize);
-            window.draw(panel);
+    phase.next("vectors");
+    auto drawVectors = [&](const Particle& p) {
+        sf::Vector2f momDir = vnorm(p.vel);
+        sf::Vector2f spinDir = vnorm(p.spinDir);
 
-            std::ostringstream ss;
-            ss << modeTitle(mode) << (paused ? "   [PAUSED]" : "") << "\n";
-            ss << "Keys: 1 2 3 modes   Space new decay   Up Down bias   P pause   N step   H help\n\n";
+        if (mode == Mode::SpinOnly) {
+            sf::Vector2f a = p.pos;
+            sf::Vector2f b = p.pos + spinDir * 55.f;
+            drawArrow(gfx, a, spinDir, 55.f, sf::Color(230, 230, 230, 220));
+            segs.push_back(Seg{a, b, 1});
+            return;
+        }
 
-            ss << "Claim being tested: \"the neutrino spins opposite the electron\"\n";
-            if (mode == Mode::SpinOnly) {
-                ss << "Result: ALWAYS looks true here (by design). This mode is the oversimplified story.\n";
-            } else {
-                ss << "Result in this frame: " << (claimLooksTrue ? "looks true" : "does NOT look true") << " (spin dot = "
-                   << std::fixed << std::setprecision(2) << spinDot << ")\n";
+        // momentum
+        {
+            sf::Vector2f a = p.pos;
+            sf::Vector2f b = p.pos + momDir * 60.f;
+            drawArrow(gfx, a, momDir, 60.f, sf::Color(150, 150, 150, 220));
+            segs.push_back(Seg{a, b, 0});
+        }
+
+        // spin
+        {
+            sf::Vector2f off = vperp(momDir) * 10.f;
+            sf::Vector2f a = p.pos + off;
+            sf::Vector2f b = a + spinDir * 48.f;
+            drawArrow(gfx, a, spinDir, 48.f, sf::Color(235, 235, 235, 220));
+            segs.push_back(Seg{a, b, 1});
+        }
+    };
+
+    drawVectors(current.electron);
+    drawVectors(current.antinu);
+
+    // Neutron spin (+1 along +y), beside the neutron so it clears its label
+    {
+        sf::Vector2f dir{0.f, current.neutronSpinSign > 0 ? 1.f : -1.f};
+        sf::Vector2f a = origin + sf::Vector2f{-30.f, -dir.y * 20.f};
+        drawArrow(gfx, a, dir, 40.f, sf::Color(235, 235, 235, 220));
+        segs.push_back(Seg{a, a + dir * 40.f, 1});
+    }
+
+    // Proton recoil: arrow length grows with its momentum, up to 60 px at 1 MeV/c
+    float recoil = vlen(current.protonVel) / kRecoilPxPerMeV;
+    if (mode != Mode::SpinOnly && recoil > 0.01f) {
+        sf::Vector2f dir = vnorm(current.protonVel);
+        float len = 60.f * std::min(1.f, recoil);
+        drawArrow(gfx, protonPos, dir, len, sf::Color(150, 150, 150, 220));
+        segs.push_back(Seg{protonPos, protonPos + dir * len, 0});
+    }
+
+    // HUD and teaching text
+    phase.next("HUD");
+    if (hasFont) {
+        DrawTag hud(gfx, DrawHelper::Hud);
+
+        // Top panel
+        sf::Vector2f panelPos{arena.position.x + 10.f, arena.position.y + 10.f};
+        sf::Vector2f panelSize{arena.size.x - 20.f, 140.f};
+        auto panel = hudPanel(panelPos, panelSize);
+        gfx.drawShape(panel);
+
+        std::ostringstream ss;
+        ss << modeTitle(mode) << (paused ? "   [PAUSED]" : "");
+        if (v.replay) {
+            ss << "   [REPLAY decay " << v.replayIndex << " of " << v.replay->count() << ", seed " << v.replay->header().seed << "]\n";
+            ss << "Keys: Space/Right next decay   Left previous decay   P pause   N step   H help   S stats   D draws\n\n";
+        } else {
+            ss << "   " << channels.title[ch] << "\n";
+            ss << "Keys: 1 2 3 modes   Space new decay   Up Down bias   PgUp PgDn polarization   C channel\n";
+            ss << "      P pause   N step   H help   S stats   D draws\n";
+        }
+
+        ss << "Claim being tested: \"the neutrino spins opposite the electron\"\n";
+        if (mode == Mode::SpinOnly) {
+            ss << "Result: ALWAYS looks true here (by design). This mode is the oversimplified story.\n";
+        } else {
+            ss << "Result in this frame: " << (claimLooksTrue ? "looks true" : "does NOT look true") << " (spin dot = "
+               << std::fixed << std::setprecision(2) << spinDot << ")\n";
+        }
+
+        if (mode == Mode::SpinOnly) {
+            ss << "What you are seeing: ONLY spin arrows. Motion is hidden, so the shortcut seems valid.\n";
+        } else if (mode == Mode::SpinAndMotion) {
+            ss << "What you are seeing: momentum (gray) and spin (white). Helicity depends on BOTH.\n";
+        } else {
+            ss << "What you are seeing: when spins do not balance, the swirl indicates extra angular momentum from motion.\n";
+        }
+
+        sf::Text text(font);
+        text.setCharacterSize(16);
+        text.setFillColor(sf::Color(230, 230, 230));
+        text.setPosition(panelPos + sf::Vector2f{10.f, 8.f});
+        text.setString(ss.str());
+        gfx.drawText(text);
+
+        // Bottom panel: numeric readout only when it helps learning
+        if (showHelp) {
+            sf::Vector2f p2{arena.position.x + 10.f, arena.position.y + arena.size.y - 120.f};
+            sf::Vector2f s2{arena.size.x - 20.f, 110.f};
+            auto panel2 = hudPanel(p2, s2);
+            gfx.drawShape(panel2);
+
+            std::ostringstream s2s;
+            s2s << "left bias: " << std::fixed << std::setprecision(2) << leftHandBias << "   polarization: "
+                << v.polarization << "   neutron spin sign: " << (current.neutronSpinSign > 0 ? "+1" : "-1")
+                << "   proton spin sign: " << (current.protonSpinSign > 0 ? "+1" : "-1");
+            if (channels.chargedSide[ch] > 0) {
+                s2s << "   neutrino energy: " << std::setprecision(3) << channels.q[ch] << " MeV (all of Q)";
+            } else if (current.electronT >= 0.f) {
+                s2s << "   " << current.electron.name << " energy: " << std::setprecision(3) << current.electronT << " MeV ("
+                    << current.antinu.name << " " << channels.q[ch] - current.electronT << " MeV)";
             }
+            s2s << "\n" << channels.parentLabel[ch] << ": " << channels.detail[ch] << "\n";
 
             if (mode == Mode::SpinOnly) {
-                ss << "What you are seeing: ONLY spin arrows. Motion is hidden, so the shortcut seems valid.\n";
-            } else if (mode == Mode::SpinAndMotion) {
-                ss << "What you are seeing: momentum (gray) and spin (white). Helicity depends on BOTH.\n";
+                s2s << "Mode 1 note: this forces opposite spins, so it cannot teach helicity or why the shortcut fails.\n";
             } else {
-                ss << "What you are seeing: when spins do not balance, the swirl indicates extra angular momentum from motion.\n";
-            }
-
-            sf::Text text(font);
-            text.setCharacterSize(16);
-            text.setFillColor(sf::Color(230, 230, 230));
-            text.setPosition(panelPos + sf::Vector2f{10.f, 8.f});
-            text.setString(ss.str());
-            window.draw(text);
-
-            // Bottom panel: numeric readout only when it helps learning
-            if (showHelp) {
-                sf::Vector2f p2{arena.position.x + 10.f, arena.position.y + arena.size.y - 120.f};
-                sf::Vector2f s2{arena.size.x - 20.f, 110.f};
-                auto panel2 = hudPanel(p2, s2);
-                window.draw(panel2);
-
-                std::ostringstream s2s;
-                s2s << "left bias: " << std::fixed << std::setprecision(2) << leftHandBias << "   proton spin sign: "
-                    << (current.protonSpinSign > 0 ? "+1" : "-1") << "\n";
-
-                if (mode == Mode::SpinOnly) {
-                    s2s << "Mode 1 note: this forces opposite spins, so it cannot teach helicity or why the shortcut fails.\n";
+                if (channels.chargedSide[ch] > 0) {
+                    s2s << "captured electron: no momentum, so no helicity";
                 } else {
-                    s2s << "electron helicity: " << (hE > 0 ? "+1" : "-1")
-                        << "   anti nu helicity: " << (hN > 0 ? "+1" : "-1") << "\n";
-                    s2s << "Helicity = sign(spin dot momentum). Flip motion and helicity can change.\n";
+                    s2s << current.electron.name << " helicity: " << (hE > 0 ? "+1" : "-1");
                 }
+                s2s << "   " << current.antinu.name << " helicity: " << (hN > 0 ? "+1" : "-1") << "\n";
+                s2s << "Helicity = sign(spin dot momentum). Flip motion and helicity can change.\n";
+            }
 
-                if (mode == Mode::FullConservation) {
-                    if (current.L_needed == 0) {
-                        s2s << "Conservation: spins alone balance (L_needed = 0).\n";
-                    } else {
-                        s2s << "Conservation: spins do NOT balance. Extra angular momentum must come from motion (L_needed = "
-                            << current.L_needed << ").\n";
-                    }
+            if (mode == Mode::FullConservation) {
+                if (current.L_needed == 0) {
+                    s2s << "Conservation: spins alone balance (L_needed = 0).\n";
                 } else {
-                    s2s << "Tip: switch to Mode 3 to see why spin-only balancing is not generally sufficient.\n";
+                    s2s << "Conservation: spins do NOT balance. Extra angular momentum must come from motion (L_needed = "
+                        << current.L_needed << ").\n";
                 }
+            } else {
+                s2s << "Tip: switch to Mode 3 to see why spin-only balancing is not generally sufficient.\n";
+            }
 
-                sf::Text text2(font);
-                text2.setCharacterSize(16);
-                text2.setFillColor(sf::Color(230, 230, 230));
-                text2.setPosition(p2 + sf::Vector2f{10.f, 8.f});
-                text2.setString(s2s.str());
-                window.draw(text2);
+            sf::Text text2(font);
+            text2.setCharacterSize(16);
+            text2.setFillColor(sf::Color(230, 230, 230));
+            text2.setPosition(p2 + sf::Vector2f{10.f, 8.f});
+            text2.setString(s2s.str());
+            gfx.drawText(text2);
+
+            // Only channels that emit a charged lepton have a spectrum to show.
+            if (const BetaSpectrum* shape = channels.spectrum[v.channel]) {
+                sf::Vector2f p6{arena.position.x + 10.f, p2.y - 140.f};
+                drawSpectrumPanel(gfx, font, p6, v.spectrum, *shape, channels.chargedLabel[v.channel]);
             }
         }
 
-        // Hover: dots
-        if (hitCircle(mouse, origin, 24.f)) {
-            tip.active = true;
-            tip.title = TIP_NEUTRON_TITLE;
-            tip.body = TIP_NEUTRON_BODY;
-        } else if (hitCircle(mouse, protonPos, 20.f)) {
-            tip.active = true;
-            tip.title = TIP_PROTON_TITLE;
-            tip.body = TIP_PROTON_BODY;
-        } else if (hitCircle(mouse, current.electron.pos, 18.f)) {
-            tip.active = true;
-            tip.title = TIP_ELECTRON_TITLE;
-            tip.body = TIP_ELECTRON_BODY;
-        } else if (hitCircle(mouse, current.antinu.pos, 16.f)) {
+        if (showStats && v.live) {
+            sf::Vector2f p3{arena.position.x + arena.size.x - 290.f, arena.position.y + 160.f};
+            drawStatsPanel(gfx, font, p3, v.live->latest());
+        }
+
+        if (v.population) {
+            // Next to the stats panel, clear of the neutron on the left
+            sf::Vector2f p5{arena.position.x + arena.size.x - 600.f, arena.position.y + 160.f};
+            drawPopulationPanel(gfx, font, p5, *v.population, v.released);
+        }
+
+        if (showDraws && v.drawStats) {
+            sf::Vector2f p4{arena.position.x + 10.f, arena.position.y + 160.f};
+            drawProfilerPanel(gfx, font, p4, *v.drawStats);
+        }
+    }
+
+    // Hover: dots
+    phase.next("hover");
+    if (hitCircle(mouse, origin, 24.f)) {
+        tip.active = true;
+        tip.id = TipId::Neutron;
+    } else if (hitCircle(mouse, protonPos, 20.f)) {
+        tip.active = true;
+        tip.id = TipId::Proton;
+    } else if (hitCircle(mouse, current.electron.pos, 18.f)) {
+        tip.active = true;
+        tip.id = TipId::Electron;
+    } else if (hitCircle(mouse, current.antinu.pos, 16.f)) {
+        tip.active = true;
+        tip.id = TipId::AntiNu;
+    }
+
+    // Hover: swirl (Mode 3 only)
+    if (!tip.active && mode == Mode::FullConservation) {
+        // Treat swirl as a ring around origin: detect near radius band
+        float d = vlen(mouse - origin);
+        float targetR = 22.f + std::abs(current.L_needed) * 10.f;
+        if (std::abs(d - targetR) < 14.f) {
             tip.active = true;
-            tip.title = TIP_ANTINU_TITLE;
-            tip.body = TIP_ANTINU_BODY;
+            tip.id = TipId::Swirl;
         }
+    }
 
-        // Hover: swirl (Mode 3 only)
-        if (!tip.active && mode == Mode::FullConservation) {
-            // Treat swirl as a ring around origin: detect near radius band
-            float d = vlen(mouse - origin);
-            float targetR = 22.f + std::abs(current.L_needed) * 10.f;
-            if (std::abs(d - targetR) < 14.f) {
+    // Hover: arrows
+    if (!tip.active) {
+        for (const auto& s : segs) {
+            float d = pointSegmentDistance(mouse, s.a, s.b);
+            if (d < 8.f) {
                 tip.active = true;
-                tip.title = TIP_SWIRL_TITLE;
-                tip.body = TIP_SWIRL_BODY;
+                tip.id = (s.kind == 0) ? TipId::Momentum : TipId::Spin;
+                break;
             }
         }
+    }
 
-        // Hover: arrows
-        if (!tip.active) {
-            for (const auto& s : segs) {
-                float d = pointSegmentDistance(mouse, s.a, s.b);
-                if (d < 8.f) {
-                    tip.active = true;
-                    if (s.kind == 0) {
-                        tip.title = TIP_MOM_TITLE;
-                        tip.body = TIP_MOM_BODY;
-                    } else {
-                        tip.title = TIP_SPIN_TITLE;
-                        tip.body = TIP_SPIN_BODY;
-                    }
-                    break;
-                }
+    // Draw tooltip last (on top of everything)
+    phase.next("tooltip");
+    if (hasFont && tip.active) {
+        v.tips.draw(gfx, font, tip.id, mouse);
+    }
+}
+
+// The CPU rasterizer does not draw text, so frames are drawn as without a
+// font: no labels, HUD panels or tooltips rather than empty boxes.
+static int runRenderFrames(const Options& opt, Viz& viz, const sf::Font& font) {
+    SoftwareBackend frame(1100u, 700u, opt.threads);
+    FrameExporter out(opt.renderDir, opt.frameFormat);
+    const float dt = 1.f / 60.f;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < opt.renderFrames; ++i) {
+        TraceScope span("frame", static_cast<std::int64_t>(i));
+        TraceScope phase("update");
+        advanceViz(viz, frameDt(viz, dt));
+        phase.next("draw");
+        drawViz(frame, viz, font, false, sf::Vector2f{-1000.f, -1000.f});
+        phase.next("rasterize");
+        frame.finish();
+        phase.next("submit");
+        out.submit(frame.size(), frame.pixels());
+    }
+    if (!out.finish()) {
+        std::cerr << out.failed() << " frames could not be written to " << opt.renderDir << "\n";
+        return 1;
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "rendered " << opt.renderFrames << " frames to " << opt.renderDir << " in " << std::fixed
+              << std::setprecision(2) << secs << " s\n";
+    return 0;
+}
+
+// Average draw calls and vertices per frame, by primitive type and by draw helper.
+static void printRenderStats(std::ostream& os, const RenderStats& st) {
+    const double frames = st.frames ? static_cast<double>(st.frames) : 1.0;
+    auto row = [&](const char* name, const DrawCount& c) {
+        os << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1) << std::setw(12)
+           << static_cast<double>(c.calls) / frames << std::setw(14) << static_cast<double>(c.vertices) / frames
+           << std::setw(16) << static_cast<double>(c.stateChanges) / frames << "\n";
+    };
+
+    os << "\nper frame            draw calls      vertices   state changes\n";
+    row("total", st.total);
+    os << "\n";
+    for (int i = 0; i < kPrimitiveTypes; ++i) {
+        const DrawCount& c = st.byPrimitive[static_cast<std::size_t>(i)];
+        if (c.calls) row(primitiveName(static_cast<sf::PrimitiveType>(i)), c);
+    }
+    os << "\n";
+    for (int i = 0; i < kDrawHelperCount; ++i) {
+        const DrawCount& c = st.byHelper[static_cast<std::size_t>(i)];
+        if (c.calls) row(drawHelperName(static_cast<DrawHelper>(i)), c);
+    }
+}
+
+// Everything a frame does except rasterizing, as fast as it will go. The mouse
+// follows the electron so the hover tests and the tooltip run every frame.
+// With an input log the frames take its time steps and keys instead of a
+// fixed 1/60 s (at most N of them), and the final state checksum is printed
+// as after a windowed replay.
+static int runSimFrames(const Options& opt, Viz& viz, const sf::Font& font, bool hasFont, InputLog* input) {
+    CountingBackend counter(sf::Vector2u{1100u, 700u});
+
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t done = 0;
+    for (; done < opt.simFrames; ++done) {
+        float dtInput = 1.f / 60.f;
+        if (input && !input->nextFrame(dtInput)) break;
+        auto t0 = std::chrono::steady_clock::now();
+        float dt = frameDt(viz, dtInput);
+        sf::Keyboard::Key code;
+        while (input && input->nextKey(code)) handleKey(viz, code);
+        advanceViz(viz, dt);
+        counter.beginFrame();
+        drawViz(counter, viz, font, hasFont, viz.current.electron.pos);
+        counter.endFrame();
+        double work = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        viz.detail.frame(work, work);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const double frames = static_cast<double>(done);
+    std::cout << done << " frames in " << std::fixed << std::setprecision(3) << secs << " s: "
+              << std::setprecision(0) << (secs > 0.0 ? frames / secs : 0.0) << " frames/s, " << std::setprecision(2)
+              << secs * 1e6 / frames << " us/frame" << (hasFont ? "" : " (no font, text skipped)") << "\n";
+    printRenderStats(std::cout, counter.totals());
+    if (input) {
+        std::cout << "replayed " << done << " of " << input->frames() << " frames, final state " << std::hex
+                  << vizChecksum(viz) << std::dec << "\n";
+    }
+    return 0;
+}
+
+// q-th quantile of sorted values, nearest rank.
+static double percentile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    std::size_t i = static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+// Scripted window session for comparing rendering changes: vsync off, fixed
+// 1/60 s simulation step, modes cycling 1 -> 2 -> 3 every 3 simulated seconds
+// and the mouse kept on the electron so its tooltip is always drawn. Each
+// frame is timed from polling to display().
+static int runBenchFrames(const Options& opt, sf::RenderWindow& window, CountingBackend& gfx, Viz& viz,
+                          const sf::Font& font, bool hasFont) {
+    const sf::Keyboard::Key modeKeys[] = {sf::Keyboard::Key::Num1, sf::Keyboard::Key::Num2, sf::Keyboard::Key::Num3};
+    const std::uint64_t framesPerMode = 180;
+
+    std::vector<double> frameMs;
+    frameMs.reserve(static_cast<std::size_t>(opt.benchFrames));
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < opt.benchFrames && window.isOpen(); ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        TraceScope frame("frame", static_cast<std::int64_t>(i));
+
+        TraceScope phase("poll");
+        while (auto ev = window.pollEvent()) {
+            if (ev->is<sf::Event::Closed>()) window.close();
+        }
+        if (i % framesPerMode == 0) handleKey(viz, modeKeys[(i / framesPerMode) % 3]);
+
+        phase.next("update");
+        advanceViz(viz, frameDt(viz, 1.f / 60.f));
+
+        phase.next("draw");
+        gfx.beginFrame();
+        drawViz(gfx, viz, font, hasFont, viz.current.electron.pos);
+        gfx.endFrame();
+        double work = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        viz.detail.frame(frameMs.empty() ? work : frameMs.back() / 1e3, work);
+
+        phase.next("display");
+        window.display();
+        phase.end();
+        frame.end();
+
+        frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> sorted = frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (double ms : frameMs) sum += ms;
+    const double n = static_cast<double>(frameMs.size());
+
+    std::cout << frameMs.size() << " frames, seed " << opt.seed << (hasFont ? "" : ", no font (text skipped)") << "\n";
+    std::cout << std::fixed << std::setprecision(3) << "frame time ms: avg " << (n > 0.0 ? sum / n : 0.0) << "   p50 "
+              << percentile(sorted, 0.50) << "   p99 " << percentile(sorted, 0.99) << "   max "
+              << (sorted.empty() ? 0.0 : sorted.back()) << "\n";
+    std::cout << std::setprecision(1) << "fps: " << (secs > 0.0 ? n / secs : 0.0) << "\n";
+    printRenderStats(std::cout, gfx.totals());
+    return 0;
+}
+
+static int runConvertNuclides(const Options& opt) {
+    std::uint32_t n = 0;
+    std::string error;
+    if (!convertNuclideText(opt.convertNuclides, opt.nuclideDb, n, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    std::cout << n << " nuclides written to " << opt.nuclideDb << "\n";
+    return 0;
+}
+
+// Adds the --nuclide isotopes to the channel table, then parses --channels,
+// which may name them. Without --channels the first isotope is the default.
+// Runs before any thread or log touches the table.
+static bool setupChannels(Options& opt) {
+    std::string list = opt.channelList;
+    if (!opt.nuclides.empty()) {
+        NuclideDb db;
+        if (!db.open(opt.nuclideDb)) {
+            std::cerr << opt.nuclideDb << ": " << db.error() << "\n";
+            return false;
+        }
+        for (const std::string& name : opt.nuclides) {
+            int z = 0, a = 0;
+            const NuclideRecord* r = parseNuclideName(name, z, a) ? db.find(z, a) : nullptr;
+            if (!r) {
+                std::cerr << opt.nuclideDb << ": no nuclide " << name << "\n";
+                return false;
+            }
+            std::uint8_t id = 0;
+            std::string error;
+            if (!addNuclideChannel(*r, id, error)) {
+                std::cerr << error << "\n";
+                return false;
             }
+            if (list.empty()) list = decayChannels().key[id];
         }
+    }
+    if (!list.empty() && !parseChannelMix(list, opt.channels)) {
+        std::cerr << "bad value for --channels: " << list << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Copies the frame just drawn (the back buffer, before display()) into px as
+// RGBA rows, top row first. The read waits for the GPU, but px keeps its
+// capacity and the exporter recycles its own buffers, so recording does not
+// allocate once the first frames are queued.
+static void readWindowPixels(sf::RenderWindow& window, std::vector<std::uint8_t>& px) {
+    const sf::Vector2u size = window.getSize();
+    const std::size_t row = static_cast<std::size_t>(size.x) * 4; // a multiple of the default pack alignment
+    px.resize(row * size.y);
+    if (!window.setActive(true)) return;
+    glReadPixels(0, 0, static_cast<GLsizei>(size.x), static_cast<GLsizei>(size.y), GL_RGBA, GL_UNSIGNED_BYTE, px.data());
+
+    // OpenGL returns the bottom row first.
+    for (unsigned y = 0; y < size.y / 2; ++y) {
+        std::uint8_t* top = px.data() + row * y;
+        std::swap_ranges(top, top + row, px.data() + row * (size.y - 1 - y));
+    }
+}
 
-        // Draw tooltip last (on top of everything)
-        if (hasFont && tip.active) {
-            drawTooltipBox(window, font, mouse, tip.title, tip.body);
+// Everything after argument parsing; returns the exit code. Pools and the
+// background sampler are finished by the time it returns.
+static int run(Options opt) {
+    if (!opt.convertNuclides.empty()) return runConvertNuclides(opt);
+    if (!setupChannels(opt)) return 1;
+    if (!opt.recordLog.empty()) return runRecord(opt);
+    if (opt.batch) return runBatchCli(opt);
+    if (opt.sweep) return runSweepCli(opt);
+    if (opt.paired) return runPairedCli(opt);
+    if (opt.correlation) return runCorrelationCli(opt);
+
+    MappedEventLog replay;
+    if (!opt.replayLog.empty()) {
+        if (!replay.open(opt.replayLog)) {
+            std::cerr << opt.replayLog << ": " << replay.error() << "\n";
+            return 1;
         }
+        if (replay.count() == 0) {
+            std::cerr << opt.replayLog << ": no decays recorded\n";
+            return 1;
+        }
+    }
+
+    // An input replay re-creates the recorded session: its seed, starting view
+    // and population.
+    InputLog inputIn;
+    Viz viz;
+    if (!opt.replayInput.empty()) {
+        if (!inputIn.load(opt.replayInput)) {
+            std::cerr << opt.replayInput << ": " << inputIn.error() << "\n";
+            return 1;
+        }
+        if (inputIn.header().population != 0 && replay.isOpen()) {
+            std::cerr << opt.replayInput << ": a population session cannot be combined with --replay-log\n";
+            return 1;
+        }
+        opt.seed = inputIn.header().seed;
+        opt.polarization = inputIn.header().polarization;
+        opt.channels = ChannelMix{};
+        opt.channels.id[0] = inputIn.header().channel;
+        opt.cloud = inputIn.header().cloud;
+        opt.population = inputIn.header().population;
+        opt.lifetime = inputIn.header().lifetime;
+        opt.tauLeap = inputIn.header().tauLeap != 0;
+        viz.mode = inputIn.mode();
+        viz.leftHandBias = inputIn.header().leftHandBias;
+    }
+
+    Population population;
+    if (opt.population > 0) {
+        auto start = std::chrono::steady_clock::now();
+        population.start(opt.population, opt.lifetime, opt.seed, opt.threads, opt.tauLeap);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (population.leaping()) {
+            std::cout << "tau-leaping " << opt.population << " neutrons\n";
+        } else {
+            std::cout << "scheduled " << opt.population << " decays in " << std::fixed << std::setprecision(2) << secs
+                      << " s\n";
+        }
+        viz.population = &population;
+    }
+
+    sf::Font font;
+    bool hasFont = loadUiFont(font);
+
+    if (opt.renderFrames > 0) {
+        // Headless: fixed 60 Hz steps through the CPU rasterizer, no window needed.
+        // The cloud keeps one detail level so the frames repeat.
+        initViz(viz, opt, replay.isOpen() ? &replay : nullptr, nullptr);
+        if (viz.detail.automatic()) viz.detail.pin(0);
+        return runRenderFrames(opt, viz, font);
+    }
+    if (opt.simFrames > 0) {
+        initViz(viz, opt, replay.isOpen() ? &replay : nullptr, nullptr);
+        return runSimFrames(opt, viz, font, hasFont, opt.replayInput.empty() ? nullptr : &inputIn);
+    }
+
+    sf::RenderWindow window(
+        sf::VideoMode(sf::Vector2u{1100u, 700u}),
+        sf::String("Beta Decay Viz (Learning Tool)"),
+        sf::Style::Titlebar | sf::Style::Close
+    );
+    window.setVerticalSyncEnabled(opt.benchFrames == 0 && !opt.replayFast);
+    if (hasFont) prebakeGlyphs(font);
+    SfmlBackend screen(window);
+    CountingBackend counted(screen);
+    viz.drawStats = &counted.lastFrame();
+
+    LiveStats live(opt.seed);
+    initViz(viz, opt, replay.isOpen() ? &replay : nullptr, &live);
+
+    if (opt.benchFrames > 0) return runBenchFrames(opt, window, counted, viz, font, hasFont);
+
+    // Recording: every frame is read off the window and encoded in the
+    // background, and time advances 1/60 s per frame however long that takes.
+    std::optional<FrameExporter> recorder;
+    std::vector<std::uint8_t> capture;
+    if (opt.recordFrames) recorder.emplace(opt.renderDir, opt.frameFormat);
+
+    // Input recording stores each frame's step and the keys handled in it;
+    // a replay feeds them back instead of the clock and the keyboard.
+    InputLogWriter inputOut;
+    if (!opt.recordInput.empty()) {
+        InputLogHeader session;
+        session.seed = opt.seed;
+        session.leftHandBias = viz.leftHandBias;
+        session.mode = static_cast<std::uint8_t>(viz.mode);
+        session.channel = viz.channel;
+        session.polarization = viz.polarization;
+        session.cloud = static_cast<std::uint32_t>(viz.cloud.size());
+        session.population = opt.population;
+        session.lifetime = opt.lifetime;
+        session.tauLeap = opt.tauLeap ? 1 : 0;
+        if (!inputOut.open(opt.recordInput, session)) {
+            std::cerr << "cannot write " << opt.recordInput << "\n";
+            return 1;
+        }
+    }
+    const bool replayingInput = !opt.replayInput.empty();
+
+    sf::Clock clock;
+    auto sessionStart = std::chrono::steady_clock::now();
+    std::uint32_t frameIndex = 0;
+
+    for (; window.isOpen(); ++frameIndex) {
+        TraceScope frame("frame", frameIndex);
+        float dtReal = clock.restart().asSeconds();
+        auto workStart = std::chrono::steady_clock::now();
+        float dtInput = recorder ? 1.f / 60.f : dtReal;
+        if (replayingInput && !inputIn.nextFrame(dtInput)) break;
+        if (inputOut.isOpen()) inputOut.frame(frameIndex, dtInput);
+        float dt = frameDt(viz, dtInput);
+
+        TraceScope phase("poll");
+        while (auto ev = window.pollEvent()) {
+            if (ev->is<sf::Event::Closed>()) window.close();
 
+            if (const auto* kp = ev->getIf<sf::Event::KeyPressed>(); kp && !replayingInput) {
+                handleKey(viz, kp->code);
+                if (inputOut.isOpen()) inputOut.key(frameIndex, kp->code);
+            }
+        }
+        sf::Keyboard::Key code;
+        while (replayingInput && inputIn.nextKey(code)) handleKey(viz, code);
+
+        phase.next("update");
+        advanceViz(viz, dt);
+
+        phase.next("draw");
+        sf::Vector2f mouse = window.mapPixelToCoords(sf::Mouse::getPosition(window));
+        counted.beginFrame();
+        drawViz(counted, viz, font, hasFont, mouse);
+        counted.endFrame();
+        viz.detail.frame(dtReal, std::chrono::duration<double>(std::chrono::steady_clock::now() - workStart).count());
+
+        if (recorder) {
+            phase.next("capture");
+            readWindowPixels(window, capture);
+            recorder->submit(window.getSize(), capture.data());
+        }
+
+        phase.next("display");
         window.display();
     }
 
+    if (replayingInput) {
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - sessionStart).count();
+        std::cout << "replayed " << frameIndex << " of " << inputIn.frames() << " frames in " << std::fixed
+                  << std::setprecision(3) << secs << " s (" << std::setprecision(1) << (secs > 0.0 ? frameIndex / secs : 0.0)
+                  << " frames/s), final state " << std::hex << vizChecksum(viz) << std::dec << "\n";
+    }
+    if (inputOut.isOpen()) {
+        if (!inputOut.close()) {
+            std::cerr << "error while writing " << opt.recordInput << "\n";
+            return 1;
+        }
+        std::cout << "recorded input for " << frameIndex << " frames to " << opt.recordInput << ", final state " << std::hex
+                  << vizChecksum(viz) << std::dec << "\n";
+    }
+
+    if (recorder) {
+        std::uint64_t frames = recorder->submitted();
+        if (!recorder->finish()) {
+            std::cerr << recorder->failed() << " of " << frames << " frames could not be written to " << opt.renderDir << "\n";
+            return 1;
+        }
+        std::cout << "recorded " << frames << " frames to " << opt.renderDir << "\n";
+    }
+
     return 0;
 }
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage();
+        return 1;
+    }
+    if (!opt.haveSeed) opt.seed = opt.benchFrames ? 1 : std::random_device{}(); // benchmarks repeat the same scene
+    if (opt.tauLeap && opt.population == 0) {
+        std::cerr << "--tau-leap needs --population N\n";
+        return 1;
+    }
+    if (opt.population > 0 && !opt.replayLog.empty()) {
+        std::cerr << "--population makes its own decays and cannot be combined with --replay-log\n";
+        return 1;
+    }
+    if (opt.cloud > 0 && (opt.population > 0 || !opt.replayLog.empty())) {
+        std::cerr << "--cloud makes its own decays and cannot be combined with --population or --replay-log\n";
+        return 1;
+    }
+    if (opt.replayFast && opt.replayInput.empty()) {
+        std::cerr << "--replay-fast needs --replay-input FILE\n";
+        return 1;
+    }
+
+    if (opt.traceFile.empty()) return run(opt);
+
+    traceStart();
+    traceThreadName("main");
+    int rc = run(opt);
+    std::uint64_t events = 0;
+    if (!traceWrite(opt.traceFile, &events)) {
+        std::cerr << "cannot write trace " << opt.traceFile << "\n";
+        return rc ? rc : 1;
+    }
+    std::cerr << "trace: " << events << " events in " << opt.traceFile << "\n";
+    return rc;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+// Read-only memory mapping of a whole file, for the binary formats that are
+// read in place (event logs, the nuclide database). Opening costs one system
+// call whatever the file size; the OS pages data in as it is touched.
+
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    // randomAccess: the caller jumps around the file, so skip readahead.
+    bool open(const std::string& path, bool randomAccess) {
+        close();
+        error_.clear();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  randomAccess ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return fail("cannot open file");
+        LARGE_INTEGER sz;
+        if (!GetFileSizeEx(file, &sz) || sz.QuadPart == 0) {
+            CloseHandle(file);
+            return fail("cannot map an empty file");
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) return fail("cannot map file");
+        void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!p) return fail("cannot map file");
+        size_ = static_cast<std::size_t>(sz.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return fail("cannot open file");
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return fail("cannot map an empty file");
+        }
+        void* p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return fail("cannot map file");
+        if (randomAccess) madvise(p, static_cast<std::size_t>(st.st_size), MADV_RANDOM);
+        size_ = static_cast<std::size_t>(st.st_size);
+#endif
+        data_ = static_cast<const unsigned char*>(p);
+        return true;
+    }
+
+    void close() {
+        if (data_) {
+#ifdef _WIN32
+            UnmapViewOfFile(data_);
+#else
+            munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+        }
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    bool isOpen() const { return data_ != nullptr; }
+    const unsigned char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    const std::string& error() const { return error_; }
+
+private:
+    bool fail(const char* why) {
+        error_ = why;
+        return false;
+    }
+
+    const unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::string error_;
+};
@@ -0,0 +1,479 @@
+#pragma once
+
+// Nuclide database: the parent and daughter spin and parity, half-life,
+// decay mode, Q and transition type of real beta emitters, so the L_needed
+// bookkeeping can be run for an isotope instead of the free neutron.
+//
+// The binary file is built once from a text table (convertNuclideText) and
+// memory-mapped at startup; nothing is parsed or copied when it is opened, so
+// a table of thousands of nuclides opens as fast as an empty one. Lookup by
+// (Z, A) is two array reads: the per-Z range gives the slot of A, and the
+// slot gives the record.
+//
+// Layout, native byte order like the event logs:
+//   NuclideDbHeader
+//   NuclideZRange[zMax + 1]   slots of Z cover A in [aMin, aMin + aCount)
+//   std::uint32_t[slotCount]  record index, or kNoNuclide
+//   NuclideRecord[count]      sorted by Z, then A
+
+#include "decay_channels.hpp"
+#include "mapped_file.hpp"
+#include "spectrum.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+enum class Transition : std::uint8_t {
+    Fermi = 0,
+    GamowTeller = 1,
+    Mixed = 2, // Fermi and Gamow-Teller, e.g. mirror nuclei
+    FirstForbidden = 3,
+    FirstForbiddenUnique = 4,
+    SecondForbidden = 5,
+    SecondForbiddenUnique = 6,
+    ThirdForbidden = 7,
+    ThirdForbiddenUnique = 8,
+};
+constexpr int kTransitionCount = 9;
+
+struct NuclideDbHeader {
+    char magic[8] = {'B', 'D', 'N', 'U', 'C', 'L', 'D', '\0'};
+    std::uint32_t version = 1;
+    std::uint32_t recordSize = 0;
+    std::uint32_t count = 0;
+    std::uint32_t slotCount = 0;
+    std::uint16_t zMax = 0;
+    std::uint16_t reserved = 0;
+    std::uint32_t reserved2 = 0;
+};
+
+struct NuclideZRange {
+    std::uint32_t firstSlot;
+    std::uint16_t aMin;
+    std::uint16_t aCount;
+};
+
+struct NuclideRecord {
+    std::uint16_t z;
+    std::uint16_t a;
+    float halfLife; // seconds
+    float q;        // MeV: endpoint of the emitted lepton, or the neutrino energy for EC
+    std::int8_t parentTwoJ;
+    std::int8_t parentParity; // +1 or -1
+    std::int8_t daughterTwoJ;
+    std::int8_t daughterParity;
+    std::uint8_t mode;       // Channel
+    std::uint8_t transition; // Transition
+    std::uint8_t reserved[6];
+};
+
+static_assert(sizeof(NuclideDbHeader) == 32, "nuclide database header layout changed");
+static_assert(sizeof(NuclideZRange) == 8, "nuclide Z range layout changed");
+static_assert(sizeof(NuclideRecord) == 24, "nuclide record layout changed");
+static_assert(std::is_trivially_copyable<NuclideRecord>::value, "records are read in place");
+
+constexpr std::uint32_t kNoNuclide = 0xffffffffu;
+
+// Largest 2J accepted (J = 15), which keeps L_needed inside the histogram
+// range and the int8 field of the event logs.
+constexpr int kMaxTwoJ = 30;
+
+// Element symbols by Z; 0 stands for the free neutron.
+inline const char* elementSymbol(int z) {
+    static const char* const symbols[] = {
+        "n",  "H",  "He", "Li", "Be", "B",  "C",  "N",  "O",  "F",  "Ne", "Na", "Mg", "Al", "Si", "P",  "S",
+        "Cl", "Ar", "K",  "Ca", "Sc", "Ti", "V",  "Cr", "Mn", "Fe", "Co", "Ni", "Cu", "Zn", "Ga", "Ge", "As",
+        "Se", "Br", "Kr", "Rb", "Sr", "Y",  "Zr", "Nb", "Mo", "Tc", "Ru", "Rh", "Pd", "Ag", "Cd", "In", "Sn",
+        "Sb", "Te", "I",  "Xe", "Cs", "Ba", "La", "Ce", "Pr", "Nd", "Pm", "Sm", "Eu", "Gd", "Tb", "Dy", "Ho",
+        "Er", "Tm", "Yb", "Lu", "Hf", "Ta", "W",  "Re", "Os", "Ir", "Pt", "Au", "Hg", "Tl", "Pb", "Bi", "Po",
+        "At", "Rn", "Fr", "Ra", "Ac", "Th", "Pa", "U",  "Np", "Pu", "Am", "Cm", "Bk", "Cf", "Es", "Fm", "Md",
+        "No", "Lr", "Rf", "Db", "Sg", "Bh", "Hs", "Mt", "Ds", "Rg", "Cn", "Nh", "Fl", "Mc", "Lv", "Ts", "Og",
+    };
+    constexpr int n = static_cast<int>(sizeof(symbols) / sizeof(symbols[0]));
+    return (z >= 0 && z < n) ? symbols[z] : nullptr;
+}
+
+// "Co-60"; the free nucleons are "n" and "p".
+inline std::string nuclideName(int z, int a) {
+    if (a == 1 && z <= 1) return z == 0 ? "n" : "p";
+    const char* sym = elementSymbol(z);
+    return (sym ? std::string(sym) : "Z" + std::to_string(z)) + "-" + std::to_string(a);
+}
+
+// "Co-60", "n", "p" or "27:60".
+inline bool parseNuclideName(const std::string& s, int& z, int& a) {
+    if (s == "n" || s == "p") {
+        z = s == "n" ? 0 : 1;
+        a = 1;
+        return true;
+    }
+    std::size_t sep = s.find_first_of(":-");
+    if (sep == std::string::npos || sep == 0 || sep + 1 >= s.size()) return false;
+    char* end = nullptr;
+    long av = std::strtol(s.c_str() + sep + 1, &end, 10);
+    if (*end != '\0' || av < 1 || av > 65535) return false;
+    a = static_cast<int>(av);
+
+    std::string left = s.substr(0, sep);
+    if (s[sep] == ':') {
+        long zv = std::strtol(left.c_str(), &end, 10);
+        if (*end != '\0' || zv < 0 || zv > 65535) return false;
+        z = static_cast<int>(zv);
+        return true;
+    }
+    for (int i = 1; elementSymbol(i); ++i) {
+        if (left == elementSymbol(i)) {
+            z = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// "5/2+", from twice the spin and the parity.
+inline std::string spinParityLabel(int twoJ, int parity) {
+    std::string s = (twoJ % 2) ? std::to_string(twoJ) + "/2" : std::to_string(twoJ / 2);
+    return s + (parity < 0 ? "-" : "+");
+}
+
+// "5/2+", "0+" or "3-" into twice the spin and the parity, 2J <= kMaxTwoJ.
+inline bool parseSpinParity(const std::string& s, int& twoJ, int& parity) {
+    if (s.size() < 2 || (s.back() != '+' && s.back() != '-')) return false;
+    parity = s.back() == '+' ? +1 : -1;
+    std::string j = s.substr(0, s.size() - 1);
+    bool half = j.size() > 2 && j.compare(j.size() - 2, 2, "/2") == 0;
+    if (half) j.resize(j.size() - 2);
+    char* end = nullptr;
+    long v = std::strtol(j.c_str(), &end, 10);
+    if (j.empty() || *end != '\0' || v < 0) return false;
+    if (half && v % 2 == 0) return false;
+    twoJ = static_cast<int>(half ? v : 2 * v);
+    return twoJ <= kMaxTwoJ;
+}
+
+inline const char* transitionName(Transition t) {
+    static const char* const names[kTransitionCount] = {
+        "allowed Fermi",        "allowed Gamow-Teller",    "allowed mixed",
+        "first forbidden",      "first forbidden unique",  "second forbidden",
+        "second forbidden unique", "third forbidden",      "third forbidden unique",
+    };
+    return names[static_cast<int>(t)];
+}
+
+// Text keys of the converter's transition column, in Transition order.
+inline bool parseTransition(const std::string& s, Transition& t) {
+    static const char* const keys[kTransitionCount] = {"F", "GT", "mixed", "1", "1u", "2", "2u", "3", "3u"};
+    for (int i = 0; i < kTransitionCount; ++i) {
+        if (s == keys[i]) {
+            t = static_cast<Transition>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// The converter's mode column: a built-in channel's key, not an isotope
+// label, so channel comes out as the Channel kind.
+inline bool parseDecayMode(const std::string& s, std::uint8_t& channel) {
+    const DecayChannels& table = decayChannels();
+    for (std::uint8_t i = 0; i < kBuiltInChannels; ++i) {
+        if (s == table.key[i]) {
+            channel = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Lowest orbital angular momentum (hbar) the leptons must carry off.
+inline int minimumLeptonL(Transition t) {
+    switch (t) {
+    case Transition::Fermi:
+    case Transition::GamowTeller:
+    case Transition::Mixed: return 0;
+    case Transition::FirstForbidden:
+    case Transition::FirstForbiddenUnique: return 1;
+    case Transition::SecondForbidden:
+    case Transition::SecondForbiddenUnique: return 2;
+    default: return 3;
+    }
+}
+
+// "613.9", "613.9s", "109.77m", "64.1h", "53.22d", "5.2714y" into seconds.
+inline bool parseHalfLife(const std::string& s, float& seconds) {
+    char* end = nullptr;
+    double v = std::strtod(s.c_str(), &end);
+    if (end == s.c_str() || !(v > 0.0)) return false;
+    std::string unit = end;
+    double scale = 0.0;
+    if (unit.empty() || unit == "s") scale = 1.0;
+    else if (unit == "m") scale = 60.0;
+    else if (unit == "h") scale = 3600.0;
+    else if (unit == "d") scale = 86400.0;
+    else if (unit == "y") scale = 365.25 * 86400.0;
+    else return false;
+    seconds = static_cast<float>(v * scale);
+    return std::isfinite(seconds);
+}
+
+inline std::string formatHalfLife(float seconds) {
+    struct Unit {
+        const char* name;
+        double seconds;
+    };
+    static const Unit units[] = {{"y", 365.25 * 86400.0}, {"d", 86400.0}, {"h", 3600.0}, {"min", 60.0}, {"s", 1.0}};
+    std::ostringstream os;
+    for (const Unit& u : units) {
+        if (seconds >= u.seconds || u.seconds == 1.0) {
+            double v = seconds / u.seconds;
+            os.precision(v < 1e5 ? 3 : 2);
+            os << v << " " << u.name;
+            break;
+        }
+    }
+    return os.str();
+}
+
+// Read-only view of a converted database.
+class NuclideDb {
+public:
+    bool open(const std::string& path) {
+        close();
+        error_.clear();
+        if (!file_.open(path, true)) return fail(file_.error());
+
+        const unsigned char* p = file_.data();
+        if (file_.size() < sizeof(NuclideDbHeader)) return fail("file too small to be a nuclide database");
+        const auto* h = reinterpret_cast<const NuclideDbHeader*>(p);
+        if (std::memcmp(h->magic, NuclideDbHeader{}.magic, sizeof(h->magic)) != 0) return fail("not a nuclide database");
+        if (h->version != 1 || h->recordSize != sizeof(NuclideRecord)) return fail("unsupported nuclide database version");
+
+        std::size_t ranges = sizeof(NuclideDbHeader);
+        std::size_t slots = ranges + sizeof(NuclideZRange) * (static_cast<std::size_t>(h->zMax) + 1);
+        std::size_t records = slots + sizeof(std::uint32_t) * h->slotCount;
+        if (file_.size() != records + sizeof(NuclideRecord) * h->count) return fail("nuclide database size does not match its header");
+
+        header_ = *h;
+        ranges_ = reinterpret_cast<const NuclideZRange*>(p + ranges);
+        slots_ = reinterpret_cast<const std::uint32_t*>(p + slots);
+        records_ = reinterpret_cast<const NuclideRecord*>(p + records);
+        return true;
+    }
+
+    void close() {
+        file_.close();
+        ranges_ = nullptr;
+        slots_ = nullptr;
+        records_ = nullptr;
+        header_ = NuclideDbHeader{};
+    }
+
+    // nullptr if (z, a) is not in the table.
+    const NuclideRecord* find(int z, int a) const {
+        if (!records_ || z < 0 || z > header_.zMax) return nullptr;
+        const NuclideZRange& r = ranges_[z];
+        if (a < r.aMin || a >= r.aMin + r.aCount) return nullptr;
+        std::uint32_t slot = r.firstSlot + static_cast<std::uint32_t>(a - r.aMin);
+        if (slot >= header_.slotCount) return nullptr;
+        std::uint32_t i = slots_[slot];
+        return i < header_.count ? &records_[i] : nullptr;
+    }
+
+    bool isOpen() const { return records_ != nullptr; }
+    std::uint32_t count() const { return header_.count; }
+    const NuclideRecord& record(std::uint32_t i) const { return records_[i]; }
+    const std::string& error() const { return error_; }
+
+private:
+    bool fail(const std::string& why) {
+        close();
+        error_ = why;
+        return false;
+    }
+
+    MappedFile file_;
+    NuclideDbHeader header_{};
+    const NuclideZRange* ranges_ = nullptr;
+    const std::uint32_t* slots_ = nullptr;
+    const NuclideRecord* records_ = nullptr;
+    std::string error_;
+};
+
+// Text table to binary database. One nuclide per line, '#' starts a comment:
+//   name  mode  Q/MeV  half-life  J^pi parent  J^pi daughter  transition
+//   Co-60 beta- 0.3179 5.2714y    5+           4+             GT
+// mode is beta-, beta+ or ec; transition one of F GT mixed 1 1u 2 2u 3 3u.
+// On failure `error` names the line.
+inline bool convertNuclideText(const std::string& textPath, const std::string& dbPath, std::uint32_t& written,
+                               std::string& error) {
+    std::ifstream in(textPath);
+    if (!in) {
+        error = "cannot open " + textPath;
+        return false;
+    }
+
+    std::vector<NuclideRecord> recs;
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        std::size_t hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+        std::istringstream fields(line);
+        std::string name, mode, q, halfLife, parent, daughter, transition, extra;
+        if (!(fields >> name)) continue;
+        auto bad = [&](const std::string& what) {
+            error = textPath + ":" + std::to_string(lineNo) + ": " + what;
+            return false;
+        };
+        if (!(fields >> mode >> q >> halfLife >> parent >> daughter >> transition) || (fields >> extra)) {
+            return bad("expected name, mode, Q, half-life, parent and daughter J^pi, transition");
+        }
+
+        NuclideRecord r{};
+        int z = 0, a = 0, pj = 0, pp = 0, dj = 0, dp = 0;
+        std::uint8_t channel = 0;
+        Transition t = Transition::Mixed;
+        char* end = nullptr;
+        float qv = std::strtof(q.c_str(), &end);
+        if (!parseNuclideName(name, z, a)) return bad("unknown nuclide " + name);
+        if (!parseDecayMode(mode, channel)) return bad("mode must be beta-, beta+ or ec");
+        if (z == 0 && channel != static_cast<std::uint8_t>(Channel::BetaMinus)) return bad("a free neutron decays beta-");
+        if (*end != '\0' || !(qv > 0.f)) return bad("bad Q " + q);
+        if (!parseHalfLife(halfLife, r.halfLife)) return bad("bad half-life " + halfLife);
+        if (!parseSpinParity(parent, pj, pp)) return bad("bad parent J^pi " + parent);
+        if (!parseSpinParity(daughter, dj, dp)) return bad("bad daughter J^pi " + daughter);
+        if (!parseTransition(transition, t)) return bad("bad transition " + transition);
+
+        r.z = static_cast<std::uint16_t>(z);
+        r.a = static_cast<std::uint16_t>(a);
+        r.q = qv;
+        r.parentTwoJ = static_cast<std::int8_t>(pj);
+        r.parentParity = static_cast<std::int8_t>(pp);
+        r.daughterTwoJ = static_cast<std::int8_t>(dj);
+        r.daughterParity = static_cast<std::int8_t>(dp);
+        r.mode = channel;
+        r.transition = static_cast<std::uint8_t>(t);
+        recs.push_back(r);
+    }
+
+    std::sort(recs.begin(), recs.end(), [](const NuclideRecord& x, const NuclideRecord& y) {
+        return x.z != y.z ? x.z < y.z : x.a < y.a;
+    });
+    for (std::size_t i = 1; i < recs.size(); ++i) {
+        if (recs[i].z == recs[i - 1].z && recs[i].a == recs[i - 1].a) {
+            error = textPath + ": " + nuclideName(recs[i].z, recs[i].a) + " is listed twice";
+            return false;
+        }
+    }
+
+    NuclideDbHeader h;
+    h.recordSize = sizeof(NuclideRecord);
+    h.count = static_cast<std::uint32_t>(recs.size());
+    h.zMax = recs.empty() ? 0 : recs.back().z;
+    std::vector<NuclideZRange> ranges(static_cast<std::size_t>(h.zMax) + 1, NuclideZRange{0, 0, 0});
+    std::vector<std::uint32_t> slots;
+    for (std::size_t i = 0; i < recs.size();) {
+        std::size_t j = i;
+        while (j < recs.size() && recs[j].z == recs[i].z) ++j;
+        NuclideZRange& r = ranges[recs[i].z];
+        r.firstSlot = static_cast<std::uint32_t>(slots.size());
+        r.aMin = recs[i].a;
+        r.aCount = static_cast<std::uint16_t>(recs[j - 1].a - recs[i].a + 1);
+        slots.resize(slots.size() + r.aCount, kNoNuclide);
+        for (std::size_t k = i; k < j; ++k) slots[r.firstSlot + (recs[k].a - r.aMin)] = static_cast<std::uint32_t>(k);
+        i = j;
+    }
+    h.slotCount = static_cast<std::uint32_t>(slots.size());
+
+    std::ofstream out(dbPath, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char*>(ranges.data()), static_cast<std::streamsize>(ranges.size() * sizeof(NuclideZRange)));
+    out.write(reinterpret_cast<const char*>(slots.data()), static_cast<std::streamsize>(slots.size() * sizeof(std::uint32_t)));
+    out.write(reinterpret_cast<const char*>(recs.data()), static_cast<std::streamsize>(recs.size() * sizeof(NuclideRecord)));
+    out.close();
+    if (!out) {
+        error = "cannot write " + dbPath;
+        return false;
+    }
+    written = h.count;
+    return true;
+}
+
+// Adds a decay channel for nuclide r and returns its id in `id`. A nuclide
+// the table already holds (the free neutron, F-18 and Be-7 are built in, or
+// one listed twice) maps to its row, so every channel is in the table once.
+// Call before any sampling thread starts (see decayChannelTable()).
+inline bool addNuclideChannel(const NuclideRecord& r, std::uint8_t& id, std::string& error) {
+    if (r.mode > static_cast<std::uint8_t>(Channel::ElectronCapture) || r.transition >= kTransitionCount ||
+        r.parentTwoJ < 0 || r.parentTwoJ > kMaxTwoJ || r.daughterTwoJ < 0 || r.daughterTwoJ > kMaxTwoJ ||
+        !(r.q > 0.f) || (r.z == 0 && r.mode != static_cast<std::uint8_t>(Channel::BetaMinus))) {
+        error = "bad database record for " + nuclideName(r.z, r.a);
+        return false;
+    }
+    const Channel mode = static_cast<Channel>(r.mode);
+    ChannelKey identity;
+    identity.z = r.z;
+    identity.a = r.a;
+    identity.kind = r.mode;
+    if (int existing = findChannel(identity); existing >= 0) {
+        id = static_cast<std::uint8_t>(existing);
+        return true;
+    }
+
+    const int daughterZ = mode == Channel::BetaMinus ? r.z + 1 : r.z - 1;
+    const std::string parent = nuclideName(r.z, r.a), daughter = nuclideName(daughterZ, r.a);
+    const Transition t = static_cast<Transition>(r.transition);
+
+    ChannelInfo c = decayChannels().row(static_cast<std::size_t>(r.mode));
+    c.identity = identity;
+    c.key = parent;
+    c.parentLabel = parent;
+    c.daughterLabel = daughter;
+    c.parentTwoJ = r.parentTwoJ;
+    c.daughterTwoJ = r.daughterTwoJ;
+    c.q = r.q;
+    if (mode == Channel::BetaMinus) c.title = "beta- (" + parent + " -> " + daughter + " e- anti-nu)";
+    if (mode == Channel::BetaPlus) c.title = "beta+ (" + parent + " -> " + daughter + " e+ nu)";
+    if (mode == Channel::ElectronCapture) c.title = "EC (" + parent + " + e- -> " + daughter + " nu)";
+
+    std::ostringstream detail;
+    detail << spinParityLabel(r.parentTwoJ, r.parentParity) << " -> " << spinParityLabel(r.daughterTwoJ, r.daughterParity)
+           << ", " << transitionName(t) << ", T1/2 " << formatHalfLife(r.halfLife);
+    if (minimumLeptonL(t) > 0) detail << ", leptons carry L >= " << minimumLeptonL(t);
+    c.detail = detail.str();
+
+    // Fermi: a = +1; Gamow-Teller: a = -1/3 and A from the spins. Mixed and
+    // forbidden transitions depend on matrix elements the table does not
+    // hold, so they get no correlation and no asymmetry.
+    c.correlationA = t == Transition::Fermi ? 1.f : (t == Transition::GamowTeller ? -1.f / 3.f : 0.f);
+    c.asymmetryA = (t == Transition::GamowTeller && mode != Channel::ElectronCapture)
+                       ? gamowTellerAsymmetry(r.parentTwoJ, r.daughterTwoJ, mode == Channel::BetaMinus)
+                       : 0.f;
+
+    // Spectra live as long as the table; a deque keeps their addresses.
+    static std::deque<BetaSpectrum> spectra;
+    if (mode == Channel::ElectronCapture) {
+        c.spectrum = nullptr;
+    } else {
+        spectra.emplace_back(r.q, mode == Channel::BetaMinus ? daughterZ : -daughterZ);
+        c.spectrum = &spectra.back();
+    }
+
+    int added = addDecayChannel(c);
+    if (added < 0) {
+        error = "too many decay channels for " + parent + " (at most " + std::to_string(DecayChannels::kMax) + ")";
+        return false;
+    }
+    id = static_cast<std::uint8_t>(added);
+    return true;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+// Common-random-numbers run: each event's draws are made once and the decay
+// is evaluated under all three modes, so mode differences are measured on the
+// same events. The paired difference of two modes then has far less noise
+// than the difference of two independent runs.
+
+#include "batch.hpp"
+#include "three_body.hpp"
+#include "work_stealing.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+constexpr int kModeCount = 3;
+
+inline Mode modeAt(int i) { return static_cast<Mode>(i + 1); }
+
+struct PairedStats {
+    std::array<DecayHistograms, kModeCount> perMode;
+    // Joint claim outcome over the three modes, bit i set if mode i + 1 looks true.
+    std::array<std::uint64_t, 1 << kModeCount> claimPattern{};
+    // Per mode pair (1,2), (1,3), (2,3): sums of d = |L_a| - |L_b| and d^2. Integers, so exact.
+    std::array<std::int64_t, 3> absLDiff{};
+    std::array<std::int64_t, 3> absLDiff2{};
+
+    static int pairIndex(int a, int b) { return a + b - 1; } // (0,1)->0 (0,2)->1 (1,2)->2
+
+    void add(const std::array<DecaySample, kModeCount>& s) {
+        int pattern = 0;
+        int absL[kModeCount];
+        for (int m = 0; m < kModeCount; ++m) {
+            perMode[static_cast<std::size_t>(m)].add(s[static_cast<std::size_t>(m)]);
+            if (claimLooksTrue(sampleSpinDot(s[static_cast<std::size_t>(m)]))) pattern |= 1 << m;
+            absL[m] = std::abs(s[static_cast<std::size_t>(m)].L_needed);
+        }
+        ++claimPattern[static_cast<std::size_t>(pattern)];
+        for (int a = 0; a < kModeCount; ++a) {
+            for (int b = a + 1; b < kModeCount; ++b) {
+                std::int64_t d = absL[a] - absL[b];
+                absLDiff[static_cast<std::size_t>(pairIndex(a, b))] += d;
+                absLDiff2[static_cast<std::size_t>(pairIndex(a, b))] += d * d;
+            }
+        }
+    }
+
+    PairedStats& merge(const PairedStats& o) {
+        for (int m = 0; m < kModeCount; ++m) perMode[static_cast<std::size_t>(m)].merge(o.perMode[static_cast<std::size_t>(m)]);
+        for (std::size_t i = 0; i < claimPattern.size(); ++i) claimPattern[i] += o.claimPattern[i];
+        for (std::size_t i = 0; i < absLDiff.size(); ++i) {
+            absLDiff[i] += o.absLDiff[i];
+            absLDiff2[i] += o.absLDiff2[i];
+        }
+        return *this;
+    }
+
+    std::uint64_t events() const { return perMode[0].events; }
+
+    // Mean and standard error of P(claim, mode a) - P(claim, mode b).
+    void claimDiff(int a, int b, double& mean, double& stdErr) const {
+        std::uint64_t aOnly = 0, bOnly = 0;
+        for (std::size_t p = 0; p < claimPattern.size(); ++p) {
+            bool ca = (p >> a) & 1u, cb = (p >> b) & 1u;
+            if (ca && !cb) aOnly += claimPattern[p];
+            if (cb && !ca) bOnly += claimPattern[p];
+        }
+        double n = static_cast<double>(events());
+        double sum = static_cast<double>(aOnly) - static_cast<double>(bOnly);
+        double sum2 = static_cast<double>(aOnly + bOnly); // d is -1, 0 or +1
+        meanAndError(n, sum, sum2, mean, stdErr);
+    }
+
+    // Mean and standard error of |L_a| - |L_b|.
+    void absLDiffStats(int a, int b, double& mean, double& stdErr) const {
+        std::size_t i = static_cast<std::size_t>(pairIndex(a, b));
+        meanAndError(static_cast<double>(events()), static_cast<double>(absLDiff[i]), static_cast<double>(absLDiff2[i]),
+                     mean, stdErr);
+    }
+
+    static void meanAndError(double n, double sum, double sum2, double& mean, double& stdErr) {
+        mean = n > 0.0 ? sum / n : 0.0;
+        double var = n > 1.0 ? (sum2 - n * mean * mean) / (n - 1.0) : 0.0;
+        stdErr = n > 0.0 ? std::sqrt(std::max(var, 0.0) / n) : 0.0;
+    }
+};
+
+// Same blocks and seeds as runBatch(), so mode m gets exactly the events a
+// runBatch() with that mode draws; cfg.mode is ignored.
+inline PairedStats runPaired(const BatchConfig& cfg) {
+    const std::uint64_t blocks = (cfg.events + kBatchBlock - 1) / kBatchBlock;
+    const unsigned threads = batchThreads(cfg.threads);
+
+    struct alignas(kCacheLine) Worker {
+        PairedStats stats;
+    };
+    std::vector<Worker> workers(threads);
+
+    runWorkStealing(static_cast<std::size_t>(blocks), threads, [&](std::size_t b, unsigned w) {
+        TraceScope span("paired block", static_cast<std::int64_t>(b));
+        PairedStats& st = workers[w].stats;
+        std::mt19937 rng = seededRng(cfg.seed, b);
+        std::uint64_t n = std::min(kBatchBlock, cfg.events - b * kBatchBlock);
+        BlockSampler sampler(cfg.sampler, rng, n, cfg.polarization, cfg.channels);
+
+        std::array<DecaySample, kModeCount> s;
+        auto addModes = [&](const DecaySample& base) {
+            for (int m = 0; m < kModeCount; ++m) s[static_cast<std::size_t>(m)] = applyMode(base, modeAt(m));
+            st.add(s);
+        };
+        if (cfg.threeBody) {
+            // The kinematics are the same in every mode; applyMode() redoes
+            // the parts that are not (mode 1's neutrino spin and L_needed).
+            thread_local ThreeBodyBatch batch;
+            batch.run(sampler, rng, n, cfg.leftHandBias, Mode::FullConservation, cfg.angleSpread, addModes);
+            return;
+        }
+        for (std::uint64_t i = 0; i < n; ++i) {
+            DecayDraws d = sampler.nextDraws();
+            addModes(decayGeometry(d.uAngle, d.uLeft, d.protonSign, cfg.leftHandBias, cfg.angleSpread, d.neutronSign,
+                                   d.channel));
+        }
+    });
+
+    PairedStats total;
+    for (const auto& w : workers) total.merge(w.stats);
+    return total;
+}
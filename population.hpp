@@ -0,0 +1,238 @@
+#pragma once
+
+// A sample of N neutrons decaying with exponentially distributed lifetimes.
+// Every neutron's decay time is drawn once at the start and filed in a
+// hierarchical timing wheel, so scheduling is O(1) per neutron and each frame
+// only touches the decays that fall due in it, whatever N is. The wheel keeps
+// bare 32-bit expiry ticks (about 4 bytes per neutron): neutrons are
+// interchangeable, so which one decays does not matter, only when.
+//
+// Past kMaxScheduled neutrons (or on request) the sample is tau-leaped
+// instead: each step draws how many of the survivors decay from
+// Binomial(survivors, 1 - e^(-dt/tau)) and nothing is kept per neutron, so
+// 10^12 and more cost the same per frame as 10^3. The decays handed out for
+// display are then capped at kMaxSampledPerStep per step; all decays are
+// alike, so those are a fair sample of the rest.
+
+#include "decay_sim.hpp"
+#include "work_stealing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Four levels of 256 slots over absolute 32-bit ticks. An entry sits on the
+// lowest level whose slot it shares every higher byte with the current tick,
+// in the slot given by its own byte at that level. When the low byte of the
+// current tick wraps, the next slot of level 1 is spread over level 0, and so
+// on upwards, so every entry moves down at most three times before it fires.
+class TimingWheel {
+public:
+    static constexpr int kBits = 8;
+    static constexpr int kLevels = 4;
+    static constexpr std::uint32_t kSlots = 1u << kBits;
+    static constexpr std::uint32_t kMask = kSlots - 1;
+    static constexpr std::uint32_t kNever = 0xffffffffu; // ticks at or past this are never released
+
+    void reset() {
+        for (auto& level : slots_) {
+            for (auto& slot : level) std::vector<std::uint32_t>().swap(slot);
+        }
+        now_ = 0;
+        pending_ = 0;
+    }
+
+    // expiry >= now(); earlier ticks fire on the next advance.
+    void schedule(std::uint32_t expiry) {
+        if (expiry < now_) expiry = now_;
+        place(expiry);
+        ++pending_;
+    }
+
+    // Releases every entry due up to and including tick, in tick order,
+    // calling fn(expiryTick) for each.
+    template <class Fn>
+    void advanceTo(std::uint32_t tick, Fn&& fn) {
+        if (tick >= kNever) tick = kNever - 1;
+        while (now_ <= tick) {
+            std::vector<std::uint32_t>& slot = slots_[0][now_ & kMask];
+            for (std::uint32_t e : slot) fn(e);
+            pending_ -= slot.size();
+            slot.clear();
+
+            ++now_;
+            if ((now_ & kMask) == 0) cascade(1);
+        }
+    }
+
+    std::uint32_t now() const { return now_; } // next tick to be released
+    std::uint64_t pending() const { return pending_; }
+
+private:
+    void place(std::uint32_t expiry) {
+        std::uint32_t diff = expiry ^ now_;
+        int level = 0;
+        while (diff >= kSlots && level < kLevels - 1) {
+            diff >>= kBits;
+            ++level;
+        }
+        slots_[level][(expiry >> (kBits * level)) & kMask].push_back(expiry);
+    }
+
+    void cascade(int level) {
+        if (level >= kLevels) return;
+        std::uint32_t index = (now_ >> (kBits * level)) & kMask;
+        if (index == 0) cascade(level + 1); // the level above refills this one first
+
+        // Keep the slot's capacity: entries only ever move to lower levels.
+        std::vector<std::uint32_t>& slot = slots_[level][index];
+        spill_.swap(slot);
+        for (std::uint32_t e : spill_) place(e);
+        spill_.clear();
+        spill_.swap(slot);
+    }
+
+    std::vector<std::uint32_t> slots_[kLevels][kSlots];
+    std::vector<std::uint32_t> spill_;
+    std::uint32_t now_ = 0;
+    std::uint64_t pending_ = 0;
+};
+
+struct SurvivalPoint {
+    float t;
+    std::uint64_t survivors;
+};
+
+class Population {
+public:
+    static constexpr double kTicksPerSecond = 1000.0;
+    static constexpr double kActivityWindow = 0.5; // seconds of decays behind the activity readout
+    static constexpr int kCurvePoints = 320;        // survival curve samples, kCurveStepsPerLifetime per lifetime
+    static constexpr int kCurveStepsPerLifetime = 40;
+    static constexpr std::uint64_t kMaxScheduled = 100000000; // about 400 MB of wheel; larger samples are tau-leaped
+    static constexpr std::uint64_t kMaxSampledPerStep = 512;  // onDecay() calls per step when tau-leaping
+
+    // Draws all n decay times, block b from seededRng(seed, kStream + b), so
+    // the same seed gives the same population on any thread count and the
+    // view's own random stream is untouched. Blocks are drawn in parallel, a
+    // wave at a time, and filed into the wheel in block order.
+    void start(std::uint64_t n, double meanLifetime, std::uint64_t seed, unsigned threads = 0, bool tauLeap = false) {
+        wheel_.reset();
+        leaping_ = tauLeap || n > kMaxScheduled;
+        leapSurvivors_ = n;
+        leapRng_ = seededRng(seed, kStream - 1);
+        initial_ = n;
+        lifetime_ = meanLifetime;
+        time_ = 0.0;
+        recent_.clear();
+        recentDecays_ = 0;
+        curve_.clear();
+        curve_.push_back(SurvivalPoint{0.f, n});
+        if (leaping_) return;
+
+        threads = batchThreads(threads);
+        const std::uint64_t blocks = (n + kBlock - 1) / kBlock;
+        const std::uint64_t waveBlocks = 4 * static_cast<std::uint64_t>(threads);
+        const double ticksPerLifetime = meanLifetime * kTicksPerSecond;
+        std::vector<std::uint32_t> wave(static_cast<std::size_t>(std::min(blocks, waveBlocks) * kBlock));
+        WorkStealingPool pool(threads); // one set of workers for every wave
+
+        for (std::uint64_t first = 0; first < blocks; first += waveBlocks) {
+            const std::uint64_t count = std::min(waveBlocks, blocks - first);
+            auto blockSize = [&](std::uint64_t b) { return std::min(kBlock, n - b * kBlock); };
+
+            pool.run(static_cast<std::size_t>(count), [&](std::size_t task, unsigned) {
+                std::uint64_t b = first + task;
+                std::mt19937 rng = seededRng(seed, kStream + b);
+                std::uint32_t* out = wave.data() + task * kBlock;
+                for (std::uint64_t i = 0, m = blockSize(b); i < m; ++i) {
+                    // One 32-bit draw, centred so u is never 0: lifetimes reach 22 tau.
+                    double u = (static_cast<double>(rng()) + 0.5) * (1.0 / 4294967296.0);
+                    double ticks = -std::log(u) * ticksPerLifetime;
+                    out[i] = ticks < static_cast<double>(TimingWheel::kNever) ? static_cast<std::uint32_t>(ticks)
+                                                                             : TimingWheel::kNever;
+                }
+            });
+
+            for (std::uint64_t task = 0; task < count; ++task) {
+                const std::uint32_t* in = wave.data() + task * kBlock;
+                for (std::uint64_t i = 0, m = blockSize(first + task); i < m; ++i) wheel_.schedule(in[i]);
+            }
+        }
+    }
+
+    // Steps the clock by dt seconds and calls onDecay() once per neutron that
+    // decayed in the step (at most kMaxSampledPerStep times when tau-leaping).
+    // Returns how many decayed.
+    template <class Fn>
+    std::uint64_t advance(double dt, Fn&& onDecay) {
+        if (dt <= 0.0) return 0;
+        time_ += dt;
+
+        std::uint64_t decays = 0;
+        if (leaping_) {
+            if (leapSurvivors_ > 0) {
+                std::binomial_distribution<std::uint64_t> decayed(leapSurvivors_, -std::expm1(-dt / lifetime_));
+                decays = decayed(leapRng_);
+                leapSurvivors_ -= decays;
+            }
+            for (std::uint64_t i = 0, shown = std::min(decays, kMaxSampledPerStep); i < shown; ++i) onDecay();
+        } else {
+            std::uint64_t before = wheel_.pending();
+            double tick = std::min(time_ * kTicksPerSecond, static_cast<double>(TimingWheel::kNever - 1));
+            wheel_.advanceTo(static_cast<std::uint32_t>(tick), [&](std::uint32_t) { onDecay(); });
+            decays = before - wheel_.pending();
+        }
+
+        recent_.push_back({time_, decays});
+        recentDecays_ += decays;
+        while (recent_.size() > 1 && recent_.front().first < time_ - kActivityWindow) {
+            recentDecays_ -= recent_.front().second;
+            recent_.pop_front();
+        }
+
+        const double step = lifetime_ / kCurveStepsPerLifetime;
+        while (curve_.size() < kCurvePoints && time_ >= static_cast<double>(curve_.size()) * step) {
+            curve_.push_back(SurvivalPoint{static_cast<float>(static_cast<double>(curve_.size()) * step), survivors()});
+        }
+        return decays;
+    }
+
+    std::uint64_t initial() const { return initial_; }
+    std::uint64_t survivors() const { return leaping_ ? leapSurvivors_ : wheel_.pending(); }
+    bool leaping() const { return leaping_; }
+    double time() const { return time_; }
+    double lifetime() const { return lifetime_; }
+
+    // Decays per second over the last kActivityWindow seconds.
+    double activity() const {
+        if (recent_.empty()) return 0.0;
+        double span = recent_.back().first - recent_.front().first;
+        std::uint64_t n = recentDecays_ - (recent_.size() > 1 ? recent_.front().second : 0);
+        return span > 0.0 ? static_cast<double>(n) / span : 0.0;
+    }
+    // What an ideal sample of this size would show now: N0 / tau * exp(-t / tau).
+    double expectedActivity() const { return static_cast<double>(initial_) / lifetime_ * std::exp(-time_ / lifetime_); }
+
+    const std::vector<SurvivalPoint>& curve() const { return curve_; }
+
+private:
+    static constexpr std::uint64_t kStream = 0x706f70756c6174ull << 8; // "populat", then the block index
+    static constexpr std::uint64_t kBlock = 1u << 16;
+
+    TimingWheel wheel_;
+    bool leaping_ = false;
+    std::uint64_t leapSurvivors_ = 0;
+    std::mt19937 leapRng_;
+    std::uint64_t initial_ = 0;
+    double lifetime_ = 1.0;
+    double time_ = 0.0;
+
+    std::deque<std::pair<double, std::uint64_t>> recent_; // (time, decays in that step)
+    std::uint64_t recentDecays_ = 0;
+    std::vector<SurvivalPoint> curve_;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+// What the draw helpers draw into. SfmlBackend forwards to an sf::RenderTarget
+// (the window); other backends can rasterize on the CPU or only count, so the
+// same scene code runs with or without a window and an OpenGL context.
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+
+// Which draw helper a call comes from, for the draw statistics.
+enum class DrawHelper {
+    Scene, Glow, Label, Trail, Swirl, Arrow, Hud, StatsPanel, Population, Spectrum, Tooltip, Profiler, Count
+};
+
+constexpr int kDrawHelperCount = static_cast<int>(DrawHelper::Count);
+
+inline const char* drawHelperName(DrawHelper h) {
+    static const char* const names[kDrawHelperCount] = {"scene", "glow",  "label",      "trail",    "swirl",   "arrow",
+                                                         "hud",   "stats", "population", "spectrum", "tooltip", "profiler"};
+    return names[static_cast<int>(h)];
+}
+
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+
+    // Set by DrawTag; backends that keep statistics attribute calls to it.
+    DrawHelper helper = DrawHelper::Scene;
+
+    virtual sf::Vector2u size() const = 0;
+    virtual void clear(sf::Color c) = 0;
+    virtual void drawVertices(const sf::Vertex* v, std::size_t n, sf::PrimitiveType type) = 0;
+    virtual void drawShape(const sf::Shape& s) = 0;
+    virtual void drawText(const sf::Text& t) = 0;
+
+    void draw(const sf::VertexArray& va) {
+        if (va.getVertexCount() > 0) drawVertices(&va[0], va.getVertexCount(), va.getPrimitiveType());
+    }
+};
+
+class SfmlBackend : public RenderBackend {
+public:
+    explicit SfmlBackend(sf::RenderTarget& rt) : rt_(rt) {}
+
+    sf::Vector2u size() const override { return rt_.getSize(); }
+    void clear(sf::Color c) override { rt_.clear(c); }
+    void drawVertices(const sf::Vertex* v, std::size_t n, sf::PrimitiveType type) override { rt_.draw(v, n, type); }
+    void drawShape(const sf::Shape& s) override { rt_.draw(s); }
+    void drawText(const sf::Text& t) override { rt_.draw(t); }
+
+private:
+    sf::RenderTarget& rt_;
+};
+
+// Attributes the draws in its scope to helper h; restores the previous tag.
+class DrawTag {
+public:
+    DrawTag(RenderBackend& gfx, DrawHelper h) : gfx_(gfx), prev_(gfx.helper) { gfx_.helper = h; }
+    DrawTag(const DrawTag&) = delete;
+    DrawTag& operator=(const DrawTag&) = delete;
+    ~DrawTag() { gfx_.helper = prev_; }
+
+private:
+    RenderBackend& gfx_;
+    DrawHelper prev_;
+};
@@ -0,0 +1,140 @@
+#pragma once
+
+// Draw-call accounting. CountingBackend sits in front of another backend (the
+// window) and tallies what reaches it per frame, by primitive type and by the
+// draw helper that issued it; without an inner backend it only counts, which
+// takes rendering out entirely. Shapes and text are counted the way SFML
+// submits them: a shape is a triangle fan for the fill plus a triangle strip
+// for the outline, text is 6 vertices per visible glyph, drawn again for the
+// outline. A state change is a submission whose primitive type or texture
+// differs from the one before it in the frame (text is drawn from the font's
+// glyph page for its character size, everything else untextured); it is the
+// point where consecutive draws could no longer be merged into one batch.
+
+#include "render_backend.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+constexpr int kPrimitiveTypes = 6;
+
+inline const char* primitiveName(sf::PrimitiveType t) {
+    static const char* const names[kPrimitiveTypes] = {"points",    "lines",          "line strip",
+                                                       "triangles", "triangle strip", "triangle fan"};
+    return names[static_cast<int>(t)];
+}
+
+struct DrawCount {
+    std::uint64_t calls = 0;
+    std::uint64_t vertices = 0;
+    std::uint64_t stateChanges = 0;
+
+    void add(std::size_t n, bool changed) {
+        ++calls;
+        vertices += n;
+        if (changed) ++stateChanges;
+    }
+    DrawCount& merge(const DrawCount& o) {
+        calls += o.calls;
+        vertices += o.vertices;
+        stateChanges += o.stateChanges;
+        return *this;
+    }
+};
+
+struct RenderStats {
+    std::uint64_t frames = 0;
+    DrawCount total;
+    std::array<DrawCount, kPrimitiveTypes> byPrimitive{};
+    std::array<DrawCount, kDrawHelperCount> byHelper{};
+
+    void add(DrawHelper h, sf::PrimitiveType t, std::size_t n, bool changed) {
+        total.add(n, changed);
+        byPrimitive[static_cast<std::size_t>(t)].add(n, changed);
+        byHelper[static_cast<std::size_t>(h)].add(n, changed);
+    }
+
+    RenderStats& merge(const RenderStats& o) {
+        frames += o.frames;
+        total.merge(o.total);
+        for (std::size_t i = 0; i < byPrimitive.size(); ++i) byPrimitive[i].merge(o.byPrimitive[i]);
+        for (std::size_t i = 0; i < byHelper.size(); ++i) byHelper[i].merge(o.byHelper[i]);
+        return *this;
+    }
+};
+
+class CountingBackend : public RenderBackend {
+public:
+    // Counts and forwards to inner.
+    explicit CountingBackend(RenderBackend& inner) : inner_(&inner), size_(inner.size()) {}
+    // Counts only.
+    explicit CountingBackend(sf::Vector2u size) : size_(size) {}
+
+    // Bracket each frame; endFrame() makes it lastFrame() and adds it to totals().
+    void beginFrame() {
+        frame_ = RenderStats{};
+        frame_.frames = 1;
+        state_ = State{};
+    }
+    void endFrame() {
+        last_ = frame_;
+        totals_.merge(frame_);
+    }
+
+    const RenderStats& lastFrame() const { return last_; }
+    // Every completed frame since construction.
+    const RenderStats& totals() const { return totals_; }
+
+    sf::Vector2u size() const override { return inner_ ? inner_->size() : size_; }
+
+    void clear(sf::Color c) override {
+        if (inner_) inner_->clear(c);
+    }
+
+    void drawVertices(const sf::Vertex* v, std::size_t n, sf::PrimitiveType type) override {
+        submit(type, State{}, n);
+        if (inner_) inner_->drawVertices(v, n, type);
+    }
+
+    void drawShape(const sf::Shape& s) override {
+        std::size_t n = s.getPointCount();
+        submit(sf::PrimitiveType::TriangleFan, State{}, n + 2);
+        if (s.getOutlineThickness() != 0.f) submit(sf::PrimitiveType::TriangleStrip, State{}, (n + 1) * 2);
+        if (inner_) inner_->drawShape(s);
+    }
+
+    void drawText(const sf::Text& t) override {
+        const sf::String& str = t.getString();
+        std::size_t glyphs = 0;
+        for (std::size_t i = 0; i < str.getSize(); ++i) {
+            std::uint32_t c = str[i];
+            if (c != ' ' && c != '\n' && c != '\t') ++glyphs;
+        }
+        const State glyphPage{&t.getFont(), t.getCharacterSize()};
+        if (t.getOutlineThickness() != 0.f) submit(sf::PrimitiveType::Triangles, glyphPage, glyphs * 6);
+        submit(sf::PrimitiveType::Triangles, glyphPage, glyphs * 6);
+        if (inner_) inner_->drawText(t);
+    }
+
+private:
+    // What a submission binds besides its vertices; untextured is {nullptr, 0}.
+    struct State {
+        const sf::Font* font = nullptr;
+        unsigned characterSize = 0;
+        int primitive = -1;
+    };
+
+    void submit(sf::PrimitiveType type, State s, std::size_t n) {
+        s.primitive = static_cast<int>(type);
+        bool changed = state_.primitive >= 0 && (s.primitive != state_.primitive || s.font != state_.font ||
+                                                 s.characterSize != state_.characterSize);
+        state_ = s;
+        frame_.add(helper, type, n, changed);
+    }
+
+    RenderBackend* inner_ = nullptr;
+    sf::Vector2u size_;
+    RenderStats frame_, last_, totals_;
+    State state_;
+};
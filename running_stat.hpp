@@ -0,0 +1,61 @@
+#pragma once
+
+// Welford running mean/variance, with Chan's formula for combining partial
+// results from different threads, plus the interval helpers the batch tools
+// use to decide when an estimate is precise enough.
+
+#include <cmath>
+#include <cstdint>
+
+struct RunningStat {
+    std::uint64_t n = 0;
+    double mean = 0.0;
+    double m2 = 0.0; // sum of squared deviations from the mean
+
+    void add(double x) {
+        ++n;
+        double d = x - mean;
+        mean += d / static_cast<double>(n);
+        m2 += d * (x - mean);
+    }
+
+    RunningStat& merge(const RunningStat& o) {
+        if (o.n == 0) return *this;
+        if (n == 0) return *this = o;
+        double na = static_cast<double>(n);
+        double nb = static_cast<double>(o.n);
+        double d = o.mean - mean;
+        double nt = na + nb;
+        mean += d * nb / nt;
+        m2 += o.m2 + d * d * na * nb / nt;
+        n += o.n;
+        return *this;
+    }
+
+    double variance() const { return n > 1 ? m2 / static_cast<double>(n - 1) : 0.0; }
+    double stdError() const { return n > 1 ? std::sqrt(variance() / static_cast<double>(n)) : 0.0; }
+    // Half-width of the normal-approximation interval, e.g. z = 1.96 for 95%.
+    double halfWidth(double z) const { return z * stdError(); }
+};
+
+// Two-sided normal quantile for a confidence level, e.g. 0.99 -> 2.576.
+inline double zForConfidence(double confidence) {
+    double alpha = 1.0 - confidence;
+    double lo = 0.0, hi = 10.0;
+    for (int i = 0; i < 100; ++i) {
+        double mid = 0.5 * (lo + hi);
+        if (std::erfc(mid / std::sqrt(2.0)) > alpha) lo = mid;
+        else hi = mid;
+    }
+    return 0.5 * (lo + hi);
+}
+
+// Half-width of the Wilson score interval for k successes in n trials. Unlike
+// the plain normal interval it does not collapse to zero at k = 0 or k = n.
+inline double wilsonHalfWidth(std::uint64_t k, std::uint64_t n, double z) {
+    if (n == 0) return 1.0;
+    double nn = static_cast<double>(n);
+    double p = static_cast<double>(k) / nn;
+    double z2 = z * z;
+    return z / (1.0 + z2 / nn) * std::sqrt(p * (1.0 - p) / nn + z2 / (4.0 * nn * nn));
+}
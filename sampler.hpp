@@ -0,0 +1,132 @@
+#pragma once
+
+// Where the batch engine gets the two uniforms behind each decay (emission
+// angle and the left-handed coin). Pseudo is plain mt19937 and reproduces
+// sampleDecay() exactly. Stratified is a Latin hypercube over each block: one
+// draw from every 1/n slice of both axes. Sobol uses the first two Sobol
+// dimensions with a random digital shift per block. Both spread points evenly
+// over the (angle, coin) square, so estimators such as mean spin dot converge
+// much faster; since every block is an independent randomisation, the spread
+// of per-block results still gives an honest error estimate.
+
+#include "decay_sim.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+enum class Sampler { Pseudo, Stratified, Sobol };
+
+inline const char* samplerName(Sampler s) {
+    if (s == Sampler::Stratified) return "stratified";
+    if (s == Sampler::Sobol) return "sobol";
+    return "pseudo";
+}
+
+inline bool parseSampler(const std::string& name, Sampler& out) {
+    if (name == "pseudo") out = Sampler::Pseudo;
+    else if (name == "stratified") out = Sampler::Stratified;
+    else if (name == "sobol") out = Sampler::Sobol;
+    else return false;
+    return true;
+}
+
+struct DecayDraws {
+    float uAngle = 0.f;
+    float uLeft = 0.f;
+    int protonSign = +1;
+    int neutronSign = +1;
+    std::uint8_t channel = 0;
+};
+
+// 32-bit fixed point in [0, 1) as float; the top 24 bits so it never rounds up to 1.
+inline float unitFromBits(std::uint32_t x) { return static_cast<float>(x >> 8) * (1.f / 16777216.f); }
+
+// Points for one block of n events. The block's generator still supplies the
+// proton sign, the neutron spin and the channel (and, for Pseudo, everything),
+// in the same order as sampleDecay().
+class BlockSampler {
+public:
+    BlockSampler(Sampler kind, std::mt19937& rng, std::uint64_t n, float polarization = 1.f,
+                 const ChannelMix& channels = ChannelMix{})
+        : kind_(kind), rng_(rng), n_(n), polarization_(polarization), channels_(channels) {
+        if (kind_ == Sampler::Stratified) {
+            // Slice i of the angle axis is paired with slice perm[i] of the coin axis.
+            perm_.resize(static_cast<std::size_t>(n_));
+            std::iota(perm_.begin(), perm_.end(), std::uint32_t{0});
+            std::shuffle(perm_.begin(), perm_.end(), rng_);
+        } else if (kind_ == Sampler::Sobol) {
+            shiftA_ = rng_();
+            shiftB_ = rng_();
+        }
+    }
+
+    // Draws for the next event, in sampleDecay() order for Pseudo.
+    DecayDraws nextDraws() {
+        std::uniform_real_distribution<float> u01(0.f, 1.f);
+        std::uniform_int_distribution<int> pm01(0, 1);
+
+        DecayDraws d;
+        if (kind_ == Sampler::Pseudo) {
+            d.uAngle = u01(rng_);
+            d.uLeft = u01(rng_);
+        } else if (kind_ == Sampler::Stratified) {
+            float inv = 1.f / static_cast<float>(n_);
+            d.uAngle = std::min((static_cast<float>(i_) + u01(rng_)) * inv, kBelowOne);
+            d.uLeft = std::min((static_cast<float>(perm_[static_cast<std::size_t>(i_)]) + u01(rng_)) * inv, kBelowOne);
+        } else {
+            // Gray-code order: point i differs from i - 1 by one direction number.
+            if (i_ > 0) {
+                int c = ctz(i_);
+                x_ ^= 1u << (31 - c);
+                y_ ^= dir2(c);
+            }
+            d.uAngle = unitFromBits(x_ ^ shiftA_);
+            d.uLeft = unitFromBits(y_ ^ shiftB_);
+        }
+        ++i_;
+
+        d.protonSign = pm01(rng_) ? +1 : -1;
+        if (needsSpinDraw(polarization_)) d.neutronSign = neutronSignFromDraw(u01(rng_), polarization_);
+        d.channel = channels_.needsDraw() ? channels_.pick(u01(rng_)) : channels_.first();
+        return d;
+    }
+
+    DecaySample next(float leftHandBias, Mode mode, float angleSpread) {
+        DecayDraws d = nextDraws();
+        return decayFromUniforms(d.uAngle, d.uLeft, d.protonSign, leftHandBias, mode, angleSpread, d.neutronSign,
+                                 d.channel);
+    }
+
+private:
+    static constexpr float kBelowOne = 0.99999994f;
+
+    static int ctz(std::uint64_t v) {
+        int c = 0;
+        while (!(v & 1u)) {
+            v >>= 1;
+            ++c;
+        }
+        return c;
+    }
+
+    // Direction numbers of Sobol dimension 2 (primitive polynomial x + 1).
+    static std::uint32_t dir2(int c) {
+        std::uint32_t v = 1u << 31;
+        for (int k = 0; k < c; ++k) v ^= v >> 1;
+        return v;
+    }
+
+    Sampler kind_;
+    std::mt19937& rng_;
+    std::uint64_t n_;
+    float polarization_;
+    ChannelMix channels_;
+    std::uint64_t i_ = 0;
+    std::vector<std::uint32_t> perm_;
+    std::uint32_t x_ = 0, y_ = 0;
+    std::uint32_t shiftA_ = 0, shiftB_ = 0;
+};
@@ -0,0 +1,346 @@
+#pragma once
+
+// CPU rasterizer behind the RenderBackend interface, for rendering frames on
+// machines without a display or OpenGL. Draw calls are only recorded; finish()
+// splits the frame into tiles and rasterizes them in parallel, each tile
+// replaying the whole command list clipped to itself, so blending order is
+// the same as drawing in sequence.
+//
+// Supported: lines and line strips (1 px, colour interpolated), triangles /
+// strips / fans (colour interpolated), points, filled circles with a soft
+// 1 px edge, and convex shapes with SFML-style mitred outlines. Shape
+// transforms may translate and rotate but not scale circles. Text is not
+// rasterized here, so callers should leave out text and the panels behind it.
+
+#include "render_backend.hpp"
+#include "work_stealing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class SoftwareBackend : public RenderBackend {
+public:
+    static constexpr int kTile = 64;
+
+    SoftwareBackend(unsigned width, unsigned height, unsigned threads = 0)
+        : w_(static_cast<int>(width)), h_(static_cast<int>(height)),
+          px_(static_cast<std::size_t>(width) * height * 4, 0), pool_(batchThreads(threads)) {}
+
+    sf::Vector2u size() const override { return {static_cast<unsigned>(w_), static_cast<unsigned>(h_)}; }
+
+    void clear(sf::Color c) override {
+        // Nothing drawn before a clear can show, so drop it.
+        cmds_.clear();
+        verts_.clear();
+        Cmd cmd;
+        cmd.op = Op::Clear;
+        cmd.color = c;
+        cmd.x0 = 0.f;
+        cmd.y0 = 0.f;
+        cmd.x1 = static_cast<float>(w_);
+        cmd.y1 = static_cast<float>(h_);
+        cmds_.push_back(cmd);
+    }
+
+    void drawVertices(const sf::Vertex* v, std::size_t n, sf::PrimitiveType type) override {
+        switch (type) {
+        case sf::PrimitiveType::Points:
+            push(Op::Points, v, n);
+            break;
+        case sf::PrimitiveType::Lines:
+            push(Op::Lines, v, n - n % 2);
+            break;
+        case sf::PrimitiveType::LineStrip:
+            for (std::size_t i = 1; i < n; ++i) push(Op::Lines, v + i - 1, 2);
+            break;
+        case sf::PrimitiveType::Triangles:
+            push(Op::Triangles, v, n - n % 3);
+            break;
+        case sf::PrimitiveType::TriangleStrip:
+            for (std::size_t i = 2; i < n; ++i) {
+                sf::Vertex tri[3] = {v[i - 2], v[i - 1], v[i]};
+                push(Op::Triangles, tri, 3);
+            }
+            break;
+        case sf::PrimitiveType::TriangleFan:
+            for (std::size_t i = 2; i < n; ++i) {
+                sf::Vertex tri[3] = {v[0], v[i - 1], v[i]};
+                push(Op::Triangles, tri, 3);
+            }
+            break;
+        }
+    }
+
+    void drawShape(const sf::Shape& s) override {
+        const sf::Transform& tf = s.getTransform();
+        std::size_t n = s.getPointCount();
+        if (n < 3) return;
+
+        std::vector<sf::Vector2f> pts(n);
+        for (std::size_t i = 0; i < n; ++i) pts[i] = tf.transformPoint(s.getPoint(i));
+
+        if (s.getFillColor().a > 0) {
+            if (const auto* c = dynamic_cast<const sf::CircleShape*>(&s)) {
+                float r = c->getRadius();
+                pushDisc(tf.transformPoint(sf::Vector2f{r, r}), r, s.getFillColor());
+            } else {
+                for (std::size_t i = 2; i < n; ++i) {
+                    sf::Vertex tri[3] = {{pts[0], s.getFillColor()}, {pts[i - 1], s.getFillColor()}, {pts[i], s.getFillColor()}};
+                    push(Op::Triangles, tri, 3);
+                }
+            }
+        }
+
+        float th = s.getOutlineThickness();
+        if (th != 0.f && s.getOutlineColor().a > 0) pushOutline(pts, th, s.getOutlineColor());
+    }
+
+    void drawText(const sf::Text&) override {}
+
+    // Rasterize everything recorded since the last clear(), on the backend's
+    // own workers, which stay up from frame to frame.
+    void finish() {
+        const int tilesX = (w_ + kTile - 1) / kTile;
+        const int tilesY = (h_ + kTile - 1) / kTile;
+        pool_.run(static_cast<std::size_t>(tilesX * tilesY), [&](std::size_t t, unsigned) {
+            TraceScope span("raster tile", static_cast<std::int64_t>(t));
+            int tx = static_cast<int>(t) % tilesX;
+            int ty = static_cast<int>(t) / tilesX;
+            Tile tile{tx * kTile, ty * kTile, std::min(w_, (tx + 1) * kTile), std::min(h_, (ty + 1) * kTile)};
+            for (const Cmd& c : cmds_) rasterize(c, tile);
+        });
+    }
+
+    // RGBA, row-major, top row first.
+    const std::uint8_t* pixels() const { return px_.data(); }
+
+    sf::Image image() const { return sf::Image(size(), px_.data()); }
+
+private:
+    enum class Op { Clear, Points, Lines, Triangles, Disc };
+
+    struct Cmd {
+        Op op = Op::Clear;
+        std::size_t first = 0, count = 0; // into verts_
+        float x0 = 0.f, y0 = 0.f, x1 = 0.f, y1 = 0.f; // bounds
+        sf::Color color;                              // Clear, Disc
+        sf::Vector2f center;                          // Disc
+        float radius = 0.f;                           // Disc
+    };
+
+    struct Tile {
+        int x0, y0, x1, y1;
+    };
+
+    void push(Op op, const sf::Vertex* v, std::size_t n) {
+        if (n == 0) return;
+        Cmd c;
+        c.op = op;
+        c.first = verts_.size();
+        c.count = n;
+        c.x0 = c.x1 = v[0].position.x;
+        c.y0 = c.y1 = v[0].position.y;
+        for (std::size_t i = 0; i < n; ++i) {
+            verts_.push_back(v[i]);
+            c.x0 = std::min(c.x0, v[i].position.x);
+            c.y0 = std::min(c.y0, v[i].position.y);
+            c.x1 = std::max(c.x1, v[i].position.x);
+            c.y1 = std::max(c.y1, v[i].position.y);
+        }
+        c.x1 += 1.f;
+        c.y1 += 1.f;
+        cmds_.push_back(c);
+    }
+
+    void pushDisc(sf::Vector2f center, float r, sf::Color color) {
+        Cmd c;
+        c.op = Op::Disc;
+        c.center = center;
+        c.radius = r;
+        c.color = color;
+        c.x0 = center.x - r - 1.f;
+        c.y0 = center.y - r - 1.f;
+        c.x1 = center.x + r + 1.f;
+        c.y1 = center.y + r + 1.f;
+        cmds_.push_back(c);
+    }
+
+    // Outline band like SFML's: each corner moves along the mitre of its two
+    // edge normals, outward for positive thickness.
+    void pushOutline(const std::vector<sf::Vector2f>& pts, float thickness, sf::Color color) {
+        const std::size_t n = pts.size();
+        sf::Vector2f centroid;
+        for (auto p : pts) centroid += p;
+        centroid = centroid / static_cast<float>(n);
+
+        auto outwardNormal = [&](sf::Vector2f a, sf::Vector2f b) {
+            sf::Vector2f e = b - a;
+            float l = std::sqrt(e.x * e.x + e.y * e.y);
+            sf::Vector2f nrm = l > 0.f ? sf::Vector2f{-e.y / l, e.x / l} : sf::Vector2f{};
+            sf::Vector2f mid = (a + b) / 2.f - centroid;
+            if (nrm.x * mid.x + nrm.y * mid.y < 0.f) nrm = -nrm;
+            return nrm;
+        };
+
+        std::vector<sf::Vector2f> outer(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            sf::Vector2f n1 = outwardNormal(pts[(i + n - 1) % n], pts[i]);
+            sf::Vector2f n2 = outwardNormal(pts[i], pts[(i + 1) % n]);
+            float f = 1.f + (n1.x * n2.x + n1.y * n2.y);
+            sf::Vector2f m = f > 1e-4f ? (n1 + n2) / f : n1;
+            outer[i] = pts[i] + m * thickness;
+        }
+
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t j = (i + 1) % n;
+            sf::Vertex quad[6] = {{pts[i], color}, {outer[i], color}, {outer[j], color},
+                                  {pts[i], color}, {outer[j], color}, {pts[j], color}};
+            push(Op::Triangles, quad, 6);
+        }
+    }
+
+    void blend(int x, int y, sf::Color c, float coverage = 1.f) {
+        unsigned a = static_cast<unsigned>(static_cast<float>(c.a) * coverage + 0.5f);
+        if (a == 0) return;
+        std::uint8_t* d = &px_[(static_cast<std::size_t>(y) * w_ + x) * 4];
+        unsigned ia = 255 - a;
+        d[0] = static_cast<std::uint8_t>((c.r * a + d[0] * ia + 127) / 255);
+        d[1] = static_cast<std::uint8_t>((c.g * a + d[1] * ia + 127) / 255);
+        d[2] = static_cast<std::uint8_t>((c.b * a + d[2] * ia + 127) / 255);
+        d[3] = static_cast<std::uint8_t>(a + (d[3] * ia + 127) / 255);
+    }
+
+    static sf::Color lerp(sf::Color a, sf::Color b, float t) {
+        auto mix = [t](std::uint8_t x, std::uint8_t y) {
+            return static_cast<std::uint8_t>(static_cast<float>(x) + (static_cast<float>(y) - static_cast<float>(x)) * t + 0.5f);
+        };
+        return sf::Color(mix(a.r, b.r), mix(a.g, b.g), mix(a.b, b.b), mix(a.a, b.a));
+    }
+
+    void rasterize(const Cmd& c, const Tile& t) {
+        if (c.x1 <= static_cast<float>(t.x0) || c.x0 >= static_cast<float>(t.x1) || c.y1 <= static_cast<float>(t.y0) ||
+            c.y0 >= static_cast<float>(t.y1)) {
+            return;
+        }
+
+        switch (c.op) {
+        case Op::Clear:
+            for (int y = t.y0; y < t.y1; ++y) {
+                for (int x = t.x0; x < t.x1; ++x) {
+                    std::uint8_t* d = &px_[(static_cast<std::size_t>(y) * w_ + x) * 4];
+                    d[0] = c.color.r;
+                    d[1] = c.color.g;
+                    d[2] = c.color.b;
+                    d[3] = c.color.a;
+                }
+            }
+            break;
+        case Op::Points:
+            for (std::size_t i = 0; i < c.count; ++i) {
+                const sf::Vertex& v = verts_[c.first + i];
+                int x = static_cast<int>(std::floor(v.position.x));
+                int y = static_cast<int>(std::floor(v.position.y));
+                if (x >= t.x0 && x < t.x1 && y >= t.y0 && y < t.y1) blend(x, y, v.color);
+            }
+            break;
+        case Op::Lines:
+            for (std::size_t i = 0; i + 1 < c.count; i += 2) line(verts_[c.first + i], verts_[c.first + i + 1], t);
+            break;
+        case Op::Triangles:
+            for (std::size_t i = 0; i + 2 < c.count; i += 3) {
+                triangle(verts_[c.first + i], verts_[c.first + i + 1], verts_[c.first + i + 2], t);
+            }
+            break;
+        case Op::Disc:
+            disc(c, t);
+            break;
+        }
+    }
+
+    // DDA over the whole segment so every tile agrees on which pixels it
+    // covers; the end pixel is left out so joined strip segments don't blend twice.
+    void line(const sf::Vertex& a, const sf::Vertex& b, const Tile& t) {
+        sf::Vector2f d = b.position - a.position;
+        int steps = static_cast<int>(std::ceil(std::max(std::abs(d.x), std::abs(d.y))));
+        if (steps == 0) return;
+        float inv = 1.f / static_cast<float>(steps);
+        for (int i = 0; i < steps; ++i) {
+            float u = static_cast<float>(i) * inv;
+            int x = static_cast<int>(std::floor(a.position.x + d.x * u));
+            int y = static_cast<int>(std::floor(a.position.y + d.y * u));
+            if (x < t.x0 || x >= t.x1 || y < t.y0 || y >= t.y1) continue;
+            blend(x, y, lerp(a.color, b.color, u));
+        }
+    }
+
+    // Edge functions at pixel centres with a top-left fill rule, so two
+    // triangles sharing an edge (a translucent quad) never blend a pixel twice.
+    void triangle(sf::Vertex a, sf::Vertex b, sf::Vertex c, const Tile& t) {
+        auto edge = [](sf::Vector2f p, sf::Vector2f q, float x, float y) {
+            return (q.x - p.x) * (y - p.y) - (q.y - p.y) * (x - p.x);
+        };
+        float area = edge(a.position, b.position, c.position.x, c.position.y);
+        if (area == 0.f) return;
+        if (area < 0.f) {
+            std::swap(b, c);
+            area = -area;
+        }
+
+        auto topLeft = [](sf::Vector2f p, sf::Vector2f q) { return (p.y == q.y && q.x < p.x) || q.y < p.y; };
+        const bool tl0 = topLeft(b.position, c.position);
+        const bool tl1 = topLeft(c.position, a.position);
+        const bool tl2 = topLeft(a.position, b.position);
+
+        int x0 = std::max(t.x0, static_cast<int>(std::floor(std::min({a.position.x, b.position.x, c.position.x}))));
+        int y0 = std::max(t.y0, static_cast<int>(std::floor(std::min({a.position.y, b.position.y, c.position.y}))));
+        int x1 = std::min(t.x1, static_cast<int>(std::ceil(std::max({a.position.x, b.position.x, c.position.x}))) + 1);
+        int y1 = std::min(t.y1, static_cast<int>(std::ceil(std::max({a.position.y, b.position.y, c.position.y}))) + 1);
+
+        const bool flat = a.color == b.color && b.color == c.color;
+        for (int y = y0; y < y1; ++y) {
+            float py = static_cast<float>(y) + 0.5f;
+            for (int x = x0; x < x1; ++x) {
+                float pxc = static_cast<float>(x) + 0.5f;
+                float w0 = edge(b.position, c.position, pxc, py);
+                float w1 = edge(c.position, a.position, pxc, py);
+                float w2 = edge(a.position, b.position, pxc, py);
+                if (w0 < 0.f || w1 < 0.f || w2 < 0.f) continue;
+                if ((w0 == 0.f && !tl0) || (w1 == 0.f && !tl1) || (w2 == 0.f && !tl2)) continue;
+                if (flat) {
+                    blend(x, y, a.color);
+                } else {
+                    float l0 = w0 / area, l1 = w1 / area;
+                    auto ch = [&](std::uint8_t ca, std::uint8_t cb, std::uint8_t cc) {
+                        float v = l0 * ca + l1 * cb + (1.f - l0 - l1) * cc;
+                        return static_cast<std::uint8_t>(std::clamp(v + 0.5f, 0.f, 255.f));
+                    };
+                    blend(x, y, sf::Color(ch(a.color.r, b.color.r, c.color.r), ch(a.color.g, b.color.g, c.color.g),
+                                          ch(a.color.b, b.color.b, c.color.b), ch(a.color.a, b.color.a, c.color.a)));
+                }
+            }
+        }
+    }
+
+    void disc(const Cmd& c, const Tile& t) {
+        int x0 = std::max(t.x0, static_cast<int>(std::floor(c.x0)));
+        int y0 = std::max(t.y0, static_cast<int>(std::floor(c.y0)));
+        int x1 = std::min(t.x1, static_cast<int>(std::ceil(c.x1)));
+        int y1 = std::min(t.y1, static_cast<int>(std::ceil(c.y1)));
+        for (int y = y0; y < y1; ++y) {
+            float dy = static_cast<float>(y) + 0.5f - c.center.y;
+            for (int x = x0; x < x1; ++x) {
+                float dx = static_cast<float>(x) + 0.5f - c.center.x;
+                float cov = std::clamp(c.radius + 0.5f - std::sqrt(dx * dx + dy * dy), 0.f, 1.f);
+                if (cov > 0.f) blend(x, y, c.color, cov);
+            }
+        }
+    }
+
+    int w_, h_;
+    std::vector<std::uint8_t> px_;
+    std::vector<Cmd> cmds_;
+    std::vector<sf::Vertex> verts_;
+    WorkStealingPool pool_;
+};
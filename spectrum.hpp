@@ -0,0 +1,116 @@
+#pragma once
+
+// Kinetic energy of the electron from free neutron decay. The allowed shape
+//   N(T) ~ F(Z, E) p E (Q - T)^2,  E = T + m_e,  p = sqrt(E^2 - m_e^2)
+// with the non-relativistic Fermi function F = 2 pi eta / (1 - e^(-2 pi eta)),
+// eta = alpha Z E / p for the proton (Z = 1), is integrated once into
+// inverse CDF tables; a draw is then one uniform and a linear interpolation
+// between two table entries, with no allocation.
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr float kElectronMass = 0.51099895f; // MeV
+constexpr float kNeutronQ = 0.78233f;        // MeV, shared by electron and antineutrino
+
+class BetaSpectrum {
+public:
+    // The top kTailMass of the distribution, where the density falls off as
+    // (Q - T)^2, gets its own table; one evenly spaced table would put the
+    // last few percent of the energy range into a single straight segment.
+    static constexpr int kTable = 1024;
+    static constexpr float kTailMass = 1.f / 32.f;
+
+    BetaSpectrum(float q, int z) : q_(q), z_(z) {
+        // Fine trapezoid CDF first, then read off T at evenly spaced CDF values.
+        const int fine = 64 * kTable;
+        std::vector<double> cdf(fine + 1, 0.0);
+        for (int i = 1; i <= fine; ++i) {
+            double a = q_ * (i - 1) / fine, b = q_ * static_cast<double>(i) / fine;
+            cdf[static_cast<std::size_t>(i)] = cdf[static_cast<std::size_t>(i - 1)] + 0.5 * (shape(a) + shape(b)) * (b - a);
+        }
+        norm_ = cdf[static_cast<std::size_t>(fine)];
+
+        std::size_t j = 0;
+        auto invert = [&](double u) {
+            double target = norm_ * u;
+            while (j + 1 < cdf.size() - 1 && cdf[j + 1] < target) ++j;
+            double lo = cdf[j], hi = cdf[j + 1];
+            double f = hi > lo ? (target - lo) / (hi - lo) : 0.0;
+            return static_cast<float>(q_ * (static_cast<double>(j) + f) / fine);
+        };
+        const double body = 1.0 - kTailMass;
+        for (int k = 0; k < kTable; ++k) body_[static_cast<std::size_t>(k)] = invert(body * k / (kTable - 1));
+        for (int k = 0; k < kTable; ++k) tail_[static_cast<std::size_t>(k)] = invert(body + kTailMass * k / (kTable - 1));
+        body_[0] = 0.f;
+        tail_[kTable - 1] = q_;
+    }
+
+    // u uniform on [0, 1).
+    float sample(float u) const {
+        if (u < 1.f - kTailMass) return lerp(body_, u * ((kTable - 1) / (1.f - kTailMass)));
+        return lerp(tail_, (u - (1.f - kTailMass)) * ((kTable - 1) / kTailMass));
+    }
+
+    float endpoint() const { return q_; }
+
+    // Normalized probability density at T (per MeV), for overlays.
+    float density(float t) const { return static_cast<float>(shape(t) / norm_); }
+
+private:
+    static float lerp(const std::array<float, kTable>& table, float x) {
+        if (x <= 0.f) return table[0];
+        int i = static_cast<int>(x);
+        if (i >= kTable - 1) return table[kTable - 1];
+        float f = x - static_cast<float>(i);
+        return table[static_cast<std::size_t>(i)] + f * (table[static_cast<std::size_t>(i) + 1] - table[static_cast<std::size_t>(i)]);
+    }
+
+    double shape(double t) const {
+        if (t <= 0.0 || t >= q_) return 0.0;
+        const double me = kElectronMass;
+        double e = t + me;
+        double p = std::sqrt(e * e - me * me);
+        double eta = z_ * e / (137.035999 * p);
+        double fermi = 2.0 * 3.141592653589793 * eta / (1.0 - std::exp(-2.0 * 3.141592653589793 * eta));
+        return fermi * p * e * (q_ - t) * (q_ - t);
+    }
+
+    float q_;
+    int z_;
+    double norm_ = 1.0;
+    std::array<float, kTable> body_{};
+    std::array<float, kTable> tail_{};
+};
+
+inline const BetaSpectrum& neutronSpectrum() {
+    static const BetaSpectrum s(kNeutronQ, 1);
+    return s;
+}
+
+// v/c of an electron with kinetic energy t (MeV).
+inline float electronBeta(float t) {
+    float gamma = 1.f + t / kElectronMass;
+    return std::sqrt(1.f - 1.f / (gamma * gamma));
+}
+
+// Electron energies as they come in, for the HUD. Events without an
+// energy (t < 0) are skipped.
+struct EnergyHistogram {
+    static constexpr int kBins = 32; // over [0, endpoint]
+
+    float endpoint = kNeutronQ;
+    std::uint64_t events = 0;
+    std::array<std::uint64_t, kBins> counts{};
+
+    void add(float t) {
+        if (t < 0.f) return;
+        int b = static_cast<int>(t / endpoint * kBins);
+        b = b < 0 ? 0 : (b >= kBins ? kBins - 1 : b);
+        ++counts[static_cast<std::size_t>(b)];
+        ++events;
+    }
+};
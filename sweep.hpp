@@ -0,0 +1,142 @@
+#pragma once
+
+// Parameter sweeps: the batch engine run over a grid of (mode, left bias,
+// angle spread) cells. Cells are cut into block ranges ("chunks") and the
+// chunks are scheduled with work stealing, so a few cells still fill every
+// core and slow chunks don't leave workers idle.
+
+#include "batch.hpp"
+#include "work_stealing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+struct SweepConfig {
+    std::vector<Mode> modes{Mode::SpinOnly, Mode::SpinAndMotion, Mode::FullConservation};
+    std::vector<float> biases;
+    std::vector<float> spreads{kAngleSpread};
+    std::uint64_t eventsPerCell = 100000;
+    unsigned threads = 0;
+    std::uint64_t seed = 0; // every cell uses the same streams, which keeps neighbouring cells comparable
+
+    // The same for every cell, as in BatchConfig.
+    Sampler sampler = Sampler::Pseudo;
+    bool threeBody = false;
+    float polarization = 1.f;
+    ChannelMix channels;
+
+    // Per-cell early stopping, as BatchConfig::targetHalfWidth; eventsPerCell is then the budget.
+    double targetHalfWidth = 0.0;
+    double confidence = 0.95;
+};
+
+struct SweepCell {
+    Mode mode = Mode::SpinOnly;
+    float leftHandBias = 0.f;
+    float angleSpread = 0.f;
+    DecayHistograms hist;
+};
+
+// Inclusive grid from..to in steps of step (the last point is snapped to `to`).
+inline std::vector<float> gridValues(float from, float to, float step) {
+    std::vector<float> v;
+    if (step <= 0.f || to < from) {
+        v.push_back(from);
+        return v;
+    }
+    int n = static_cast<int>((to - from) / step + 0.5f);
+    for (int i = 0; i <= n; ++i) v.push_back(std::min(to, from + step * static_cast<float>(i)));
+    return v;
+}
+
+inline std::vector<SweepCell> runSweep(const SweepConfig& cfg) {
+    std::vector<SweepCell> cells;
+    for (Mode m : cfg.modes) {
+        for (float b : cfg.biases) {
+            for (float s : cfg.spreads) {
+                SweepCell c;
+                c.mode = m;
+                c.leftHandBias = b;
+                c.angleSpread = s;
+                cells.push_back(c);
+            }
+        }
+    }
+    if (cells.empty() || cfg.eventsPerCell == 0) return cells;
+
+    const unsigned threads = batchThreads(cfg.threads);
+    const std::uint64_t blocks = (cfg.eventsPerCell + kBatchBlock - 1) / kBatchBlock;
+    // Aim for a few chunks per worker overall so stealing has something to balance.
+    const std::uint64_t wantChunks = (static_cast<std::uint64_t>(threads) * 4 + cells.size() - 1) / cells.size();
+    const std::uint64_t chunksPerCell = std::max<std::uint64_t>(1, std::min(blocks, wantChunks));
+    const std::uint64_t blocksPerChunk = (blocks + chunksPerCell - 1) / chunksPerCell;
+
+    BatchConfig target;
+    target.targetHalfWidth = cfg.targetHalfWidth;
+    target.confidence = cfg.confidence;
+    const bool adaptive = cfg.targetHalfWidth > 0.0;
+
+    struct alignas(kCacheLine) Chunk {
+        DecayHistograms hist;
+    };
+    std::vector<Chunk> chunks(cells.size() * chunksPerCell);
+    std::unique_ptr<PublishedHistograms[]> published(new PublishedHistograms[chunks.size()]);
+    std::unique_ptr<std::atomic<bool>[]> cellDone(new std::atomic<bool>[cells.size()]);
+    for (std::size_t c = 0; c < cells.size(); ++c) cellDone[c].store(false, std::memory_order_relaxed);
+
+    // With a precision target, this thread merges each cell's published chunk
+    // totals every target.convergenceSeconds and retires cells that are done.
+    std::atomic<bool> finished{false};
+    std::thread monitor;
+    if (adaptive) {
+        monitor = std::thread([&] {
+            auto interval = std::chrono::duration<double>(target.convergenceSeconds);
+            while (!finished.load(std::memory_order_acquire)) {
+                std::this_thread::sleep_for(interval);
+                for (std::size_t c = 0; c < cells.size(); ++c) {
+                    if (cellDone[c].load(std::memory_order_relaxed)) continue;
+                    DecayHistograms total;
+                    for (std::uint64_t k = 0; k < chunksPerCell; ++k) published[c * chunksPerCell + k].mergeInto(total);
+                    if (batchConverged(target, total)) cellDone[c].store(true, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    runWorkStealing(chunks.size(), threads, [&](std::size_t task, unsigned) {
+        TraceScope span("sweep chunk", static_cast<std::int64_t>(task));
+        const std::size_t ci = task / chunksPerCell;
+        const SweepCell& c = cells[ci];
+        BatchConfig bc;
+        bc.events = cfg.eventsPerCell;
+        bc.seed = cfg.seed;
+        bc.mode = c.mode;
+        bc.leftHandBias = c.leftHandBias;
+        bc.angleSpread = c.angleSpread;
+        bc.sampler = cfg.sampler;
+        bc.threeBody = cfg.threeBody;
+        bc.polarization = cfg.polarization;
+        bc.channels = cfg.channels;
+
+        DecayHistograms& h = chunks[task].hist;
+        std::uint64_t first = (task % chunksPerCell) * blocksPerChunk;
+        std::uint64_t last = std::min(blocks, first + blocksPerChunk);
+        for (std::uint64_t b = first; b < last; ++b) {
+            if (cellDone[ci].load(std::memory_order_relaxed)) break;
+            forEachBlockSample(bc, b, [&](const DecaySample& s) { h.add(s); });
+            if (adaptive) published[task].publish(h);
+        }
+    });
+
+    finished.store(true, std::memory_order_release);
+    if (monitor.joinable()) monitor.join();
+
+    // Fold chunk results back into their cells.
+    for (std::size_t i = 0; i < chunks.size(); ++i) cells[i / chunksPerCell].hist.merge(chunks[i].hist);
+    return cells;
+}
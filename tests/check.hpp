@@ -0,0 +1,52 @@
+#pragma once
+
+// Minimal test harness for the CTest target: TEST(name) registers a function,
+// CHECK() records a failure and carries on, and test_main.cpp runs the test
+// named on the command line (or all of them).
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+struct TestCase {
+    const char* name;
+    void (*fn)();
+};
+
+inline std::vector<TestCase>& testRegistry() {
+    static std::vector<TestCase> r;
+    return r;
+}
+
+inline int& testFailures() {
+    static int n = 0;
+    return n;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, void (*fn)()) { testRegistry().push_back(TestCase{name, fn}); }
+};
+
+#define TEST(name)                                                 \
+    static void test_##name();                                     \
+    static const TestRegistrar registrar_##name(#name, test_##name); \
+    static void test_##name()
+
+#define CHECK(cond)                                                                      \
+    do {                                                                                 \
+        if (!(cond)) {                                                                   \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++testFailures();                                                            \
+        }                                                                                \
+    } while (0)
+
+// |a - b| <= tol, printing both values on failure.
+#define CHECK_NEAR(a, b, tol)                                                                                \
+    do {                                                                                                     \
+        const double va_ = (a), vb_ = (b);                                                                   \
+        if (!(std::fabs(va_ - vb_) <= (tol))) {                                                              \
+            std::fprintf(stderr, "%s:%d: CHECK_NEAR failed: %s = %.9g, %s = %.9g\n", __FILE__, __LINE__, #a, \
+                         va_, #b, vb_);                                                                      \
+            ++testFailures();                                                                                \
+        }                                                                                                    \
+    } while (0)
@@ -0,0 +1,23 @@
+# Plays the input log LOG back through VIZ --sim-frames on one and on four
+# threads and fails unless every replay ends in the same state checksum.
+# Usage: cmake -DVIZ=path -DLOG=file -P replay_check.cmake
+
+set(sums)
+foreach(threads 1 4)
+    execute_process(COMMAND ${VIZ} --sim-frames 100000 --replay-input ${LOG} --threads ${threads}
+                    OUTPUT_VARIABLE out ERROR_VARIABLE err RESULT_VARIABLE rc)
+    if(NOT rc EQUAL 0)
+        message(FATAL_ERROR "replay on ${threads} threads failed (${rc}):\n${out}${err}")
+    endif()
+    if(NOT out MATCHES "final state ([0-9a-f]+)")
+        message(FATAL_ERROR "no final state in replay output:\n${out}")
+    endif()
+    message(STATUS "${threads} threads: final state ${CMAKE_MATCH_1}")
+    list(APPEND sums ${CMAKE_MATCH_1})
+endforeach()
+
+list(REMOVE_DUPLICATES sums)
+list(LENGTH sums distinct)
+if(NOT distinct EQUAL 1)
+    message(FATAL_ERROR "replays disagree: ${sums}")
+endif()
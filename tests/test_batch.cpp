@@ -0,0 +1,50 @@
+#include "check.hpp"
+
+#include "../batch.hpp"
+#include "../paired.hpp"
+
+static bool sameHistograms(const DecayHistograms& a, const DecayHistograms& b) {
+    return a.events == b.events && a.claimTrue == b.claimTrue && a.lNeeded == b.lNeeded && a.spinDot == b.spinDot &&
+           a.helicity == b.helicity && a.emission == b.emission && a.channel == b.channel;
+}
+
+// A few blocks with a short tail, a mixed channel draw and the three-body path.
+static BatchConfig threadTestConfig() {
+    BatchConfig cfg;
+    cfg.events = 5 * kBatchBlock + 1234;
+    cfg.seed = 11;
+    cfg.mode = Mode::FullConservation;
+    cfg.polarization = 0.7f;
+    cfg.threeBody = true;
+    parseChannelMix("beta-:0.5,beta+:0.3,ec:0.2", cfg.channels);
+    return cfg;
+}
+
+TEST(batch_thread_count) {
+    BatchConfig cfg = threadTestConfig();
+    cfg.threads = 1;
+    const DecayHistograms one = runBatch(cfg).hist;
+    CHECK(one.events == cfg.events);
+    for (unsigned threads : {2u, 3u, 8u}) {
+        cfg.threads = threads;
+        CHECK(sameHistograms(runBatch(cfg).hist, one));
+    }
+}
+
+TEST(paired_thread_count) {
+    BatchConfig cfg = threadTestConfig();
+    cfg.threads = 1;
+    const PairedStats one = runPaired(cfg);
+    cfg.threads = 5;
+    const PairedStats five = runPaired(cfg);
+    for (int m = 0; m < kModeCount; ++m) {
+        CHECK(sameHistograms(one.perMode[static_cast<std::size_t>(m)], five.perMode[static_cast<std::size_t>(m)]));
+    }
+    CHECK(one.claimPattern == five.claimPattern);
+
+    // Each mode sees the events a single-mode run draws.
+    for (int m = 0; m < kModeCount; ++m) {
+        cfg.mode = modeAt(m);
+        CHECK(sameHistograms(runBatch(cfg).hist, one.perMode[static_cast<std::size_t>(m)]));
+    }
+}
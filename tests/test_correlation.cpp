@@ -0,0 +1,37 @@
+#include "check.hpp"
+
+#include "../correlation.hpp"
+
+static BatchConfig correlationConfig(const char* channels) {
+    BatchConfig cfg;
+    cfg.events = 1u << 20;
+    cfg.seed = 5;
+    cfg.mode = Mode::FullConservation;
+    cfg.threeBody = true;
+    parseChannelMix(channels, cfg.channels);
+    return cfg;
+}
+
+// The free neutron's a = -0.106 comes back from the sampled electron and
+// antineutrino directions, and the sums do not depend on the thread count.
+TEST(correlation_neutron) {
+    CHECK_NEAR(decayChannels().correlationA[0], -0.106, 0.001);
+
+    BatchConfig cfg = correlationConfig("beta-");
+    cfg.threads = 1;
+    const CorrelationEstimate one = estimateCorrelation(runCorrelation(cfg));
+    CHECK(one.events == cfg.events);
+    CHECK_NEAR(one.a, -0.106, 4.0 * one.aErr);
+
+    cfg.threads = 4;
+    const CorrelationEstimate four = estimateCorrelation(runCorrelation(cfg));
+    CHECK(four.a == one.a && four.meanCos == one.meanCos && four.helicityE == one.helicityE);
+}
+
+// F-18's beta+ decay is pure Gamow-Teller: a = -1/3.
+TEST(correlation_beta_plus) {
+    BatchConfig cfg = correlationConfig("beta+");
+    CHECK_NEAR(decayChannels().correlationA[static_cast<std::size_t>(Channel::BetaPlus)], -1.0 / 3.0, 1e-6);
+    const CorrelationEstimate e = estimateCorrelation(runCorrelation(cfg));
+    CHECK_NEAR(e.a, -1.0 / 3.0, 4.0 * e.aErr);
+}
@@ -0,0 +1,48 @@
+#include "check.hpp"
+
+#include "../event_log.hpp"
+
+#include <fstream>
+
+// A log stores its channels by isotope and decay mode: ids come back as this
+// run's rows, three-body kinematics come back as written, and a log naming a
+// channel the run lacks is refused.
+TEST(event_log_channel_keys) {
+    const char* path = "event_log_channels.bdl";
+    EventLogWriter out;
+    CHECK(out.open(path, 4, 0.85f));
+    DecaySample written[kBuiltInChannels];
+    for (std::uint8_t c = 0; c < kBuiltInChannels; ++c) {
+        std::mt19937 rng = seededRng(4, c);
+        written[c] = sampleThreeBody(rng, 0.85f, Mode::FullConservation, kAngleSpread, 1.f, c);
+        out.append(recordFromSample(written[c], Mode::FullConservation));
+    }
+    CHECK(out.close());
+
+    MappedEventLog log;
+    CHECK(log.open(path));
+    CHECK(log.header().version == 3);
+    CHECK(log.count() == kBuiltInChannels);
+    for (std::uint8_t c = 0; c < kBuiltInChannels && c < log.count(); ++c) {
+        CHECK(log.channel(log.record(c)) == c);
+        const DecaySample back = sampleFromRecord(log.record(c), log.channel(log.record(c)));
+        CHECK(back.channel == c);
+        CHECK(back.electronT == written[c].electronT);
+        CHECK(back.recoil == written[c].recoil);
+    }
+    log.close();
+
+    // Relabel the beta+ entry as Co-60, which this run has not loaded.
+    {
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        EventLogHeader h;
+        f.read(reinterpret_cast<char*>(&h), sizeof(h));
+        h.channels[1].z = 27;
+        h.channels[1].a = 60;
+        h.channels[1].kind = static_cast<std::uint8_t>(Channel::BetaMinus);
+        f.seekp(0);
+        f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    }
+    CHECK(!log.open(path));
+    CHECK(log.error().find("Z=27 A=60") != std::string::npos);
+}
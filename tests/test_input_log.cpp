@@ -0,0 +1,94 @@
+#include "check.hpp"
+
+#include "../input_log.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+// Written to the working directory; the input_replay test plays it back
+// through BetaDecayViz --sim-frames.
+static const char* const kSessionFile = "input_session.bdin";
+static const std::uint32_t kSessionFrames = 600;
+
+// A population session, so the replay also checks that the recorded
+// population comes back. Keys spread over it: mode switches, bias steps, new
+// decays, a channel change and a pause with a single step.
+static const std::pair<std::uint32_t, sf::Keyboard::Key> kSessionKeys[] = {
+    {20, sf::Keyboard::Key::Num2},  {60, sf::Keyboard::Key::Up},     {61, sf::Keyboard::Key::Up},
+    {120, sf::Keyboard::Key::Space}, {180, sf::Keyboard::Key::C},     {240, sf::Keyboard::Key::P},
+    {250, sf::Keyboard::Key::N},    {300, sf::Keyboard::Key::P},     {360, sf::Keyboard::Key::Num3},
+    {420, sf::Keyboard::Key::Down}, {480, sf::Keyboard::Key::Space}, {540, sf::Keyboard::Key::C},
+};
+
+TEST(input_log_session) {
+    InputLogHeader session;
+    session.seed = 7;
+    session.leftHandBias = 0.6f;
+    session.mode = static_cast<std::uint8_t>(Mode::FullConservation);
+    session.polarization = 0.8f;
+    session.population = 300000;
+    session.lifetime = 4.f;
+
+    InputLogWriter out;
+    CHECK(out.open(kSessionFile, session));
+    std::size_t next = 0;
+    for (std::uint32_t f = 0; f < kSessionFrames; ++f) {
+        out.frame(f, (f % 3 == 0) ? 1.f / 30.f : 1.f / 60.f);
+        for (; next < std::size(kSessionKeys) && kSessionKeys[next].first == f; ++next) out.key(f, kSessionKeys[next].second);
+    }
+    CHECK(out.close());
+
+    InputLog in;
+    CHECK(in.load(kSessionFile));
+    CHECK(in.header().seed == 7);
+    CHECK(in.header().leftHandBias == 0.6f);
+    CHECK(in.header().polarization == 0.8f);
+    CHECK(in.mode() == Mode::FullConservation);
+    CHECK(in.header().version == 1);
+    CHECK(in.header().population == 300000 && in.header().lifetime == 4.f && in.header().tauLeap == 0);
+    CHECK(in.frames() == kSessionFrames);
+
+    float dt = 0.f;
+    std::uint32_t frames = 0;
+    next = 0;
+    while (in.nextFrame(dt)) {
+        CHECK(dt == ((frames % 3 == 0) ? 1.f / 30.f : 1.f / 60.f));
+        sf::Keyboard::Key code;
+        while (in.nextKey(code)) {
+            CHECK(next < std::size(kSessionKeys) && kSessionKeys[next].first == frames && kSessionKeys[next].second == code);
+            ++next;
+        }
+        ++frames;
+    }
+    CHECK(frames == kSessionFrames);
+    CHECK(next == std::size(kSessionKeys));
+}
+
+// A session's channel table has to be this run's: a recording that names a
+// channel the run lacks is refused instead of replayed on the wrong row.
+TEST(input_log_channel_keys) {
+    const char* path = "input_channels.bdin";
+    InputLogWriter out;
+    CHECK(out.open(path, InputLogHeader{}));
+    out.frame(0, 1.f / 60.f);
+    CHECK(out.close());
+
+    InputLog same;
+    CHECK(same.load(path));
+    CHECK(same.header().channelCount == static_cast<std::uint32_t>(decayChannels().count));
+
+    {
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        InputLogHeader h;
+        f.read(reinterpret_cast<char*>(&h), sizeof(h));
+        h.channels[h.channelCount].z = 27;
+        h.channels[h.channelCount].a = 60;
+        ++h.channelCount;
+        f.seekp(0);
+        f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    }
+    InputLog other;
+    CHECK(!other.load(path));
+    CHECK(other.error().find("Z=27 A=60") != std::string::npos);
+}
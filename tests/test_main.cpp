@@ -0,0 +1,19 @@
+#include "check.hpp"
+
+#include <cstring>
+
+int main(int argc, char** argv) {
+    int ran = 0;
+    for (const TestCase& t : testRegistry()) {
+        if (argc > 1 && std::strcmp(argv[1], t.name) != 0) continue;
+        int before = testFailures();
+        t.fn();
+        std::printf("%s %s\n", testFailures() == before ? "ok  " : "FAIL", t.name);
+        ++ran;
+    }
+    if (ran == 0) {
+        std::fprintf(stderr, "no test named %s\n", argc > 1 ? argv[1] : "(any)");
+        return 1;
+    }
+    return testFailures() == 0 ? 0 : 1;
+}
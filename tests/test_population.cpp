@@ -0,0 +1,66 @@
+#include "check.hpp"
+
+#include "../population.hpp"
+
+#include <random>
+#include <vector>
+
+// Expiries on every level of the wheel, released by uneven advances: each
+// entry comes out exactly at its own tick, in tick order, and only once.
+TEST(timing_wheel_order) {
+    TimingWheel wheel;
+    wheel.reset();
+    std::mt19937 rng(5);
+    std::vector<std::uint32_t> expiries;
+    for (int i = 0; i < 20000; ++i) {
+        const std::uint32_t span = 1u << (8 * (i % 4) + 6); // 64, 16k, 4M and 1G ticks
+        expiries.push_back(rng() % span);
+    }
+    for (std::uint32_t boundary : {255u, 256u, 65535u, 65536u, 16777215u, 16777216u}) expiries.push_back(boundary);
+    for (std::uint32_t e : expiries) wheel.schedule(e);
+    CHECK(wheel.pending() == expiries.size());
+
+    const std::uint32_t end = 1u << 25;
+    std::uint64_t released = 0, late = 0, unordered = 0;
+    std::uint32_t last = 0;
+    std::uint32_t step = 1;
+    while (wheel.now() < end) {
+        const std::uint32_t from = wheel.now();
+        const std::uint32_t to = std::min(end - 1, from + step - 1);
+        wheel.advanceTo(to, [&](std::uint32_t e) {
+            if (e < from || e > to) ++late;
+            if (e < last) ++unordered;
+            last = e;
+            ++released;
+        });
+        step = step * 3 % 4099 + 1;
+    }
+
+    std::uint64_t due = 0;
+    for (std::uint32_t e : expiries) due += e < end;
+    CHECK(released == due);
+    CHECK(late == 0);
+    CHECK(unordered == 0);
+    CHECK(wheel.pending() == expiries.size() - due);
+
+    // Entries scheduled in the past fire on the next advance.
+    wheel.schedule(3);
+    std::uint64_t fired = 0;
+    wheel.advanceTo(wheel.now(), [&](std::uint32_t) { ++fired; });
+    CHECK(fired == 1);
+}
+
+// The decay times are drawn per block, so the survivors after every step do
+// not depend on how many threads drew them.
+TEST(population_thread_count) {
+    Population one, many;
+    one.start(3 * 65536 + 77, 2.0, 21, 1);
+    many.start(3 * 65536 + 77, 2.0, 21, 4);
+    bool same = true;
+    for (int i = 0; i < 600; ++i) {
+        const double dt = (i % 5 == 0) ? 1.0 / 30.0 : 1.0 / 60.0;
+        same = same && one.advance(dt, [] {}) == many.advance(dt, [] {}) && one.survivors() == many.survivors();
+    }
+    CHECK(same);
+    CHECK(one.survivors() < one.initial());
+}
@@ -0,0 +1,24 @@
+#include "check.hpp"
+
+#include "../trace.hpp"
+#include "../work_stealing.hpp"
+
+// Each runWorkStealing() call starts and joins its own threads, like one
+// headless frame or one population wave used to. The rows stay at one pool's
+// worth and every event is kept.
+TEST(trace_rows_reused) {
+    traceStart();
+    const std::size_t before = traceBufferCount();
+    std::size_t afterFirst = 0;
+    for (int round = 0; round < 6; ++round) {
+        runWorkStealing(32, 4, [](std::size_t task, unsigned) { TraceScope scope("task", static_cast<std::int64_t>(task)); });
+        if (round == 0) afterFirst = traceBufferCount();
+    }
+    CHECK(afterFirst <= before + 4);
+    CHECK(traceBufferCount() == afterFirst);
+
+    std::size_t events = 0;
+    for (const auto& b : traceRegistry().buffers) events += b->events.size();
+    CHECK(events == 6 * 32);
+    traceRegistry().enabled.store(false, std::memory_order_relaxed);
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+// Batched version of sampleThreeBody() for the Monte Carlo engine. Draws for a
+// chunk of events are taken from the generator in the scalar order, then the
+// kinematics run stage by stage over structure-of-arrays chunks, so each loop
+// streams through a few contiguous arrays instead of one event's scattered
+// state. Each step repeats the scalar arithmetic operation for operation, so a
+// chunk yields exactly the samples sampleThreeBody() would.
+
+#include "decay_sim.hpp"
+#include "sampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+// One chunk of results as structure-of-arrays, for reductions that would
+// rather not go through DecaySample.
+struct ThreeBodyChunk {
+    int size;
+    const float *dirEx, *dirEy, *spinEx, *spinEy;
+    const float *dirNux, *dirNuy, *spinNux, *spinNuy;
+    const float* energy; // charged lepton kinetic energy, MeV (0 when captured)
+    const float *recoilx, *recoily;
+    const int *protonSign, *neutronSign, *lNeeded;
+    const std::uint8_t* channel;
+};
+
+class ThreeBodyBatch {
+public:
+    static constexpr int kChunk = 256;
+    static constexpr std::size_t kLineAlign = 64; // arrays start on a cache line
+
+    // Calls fn(sample) for n events drawn through sampler and its generator.
+    template <class Fn>
+    void run(BlockSampler& sampler, std::mt19937& rng, std::uint64_t n, float leftHandBias, Mode mode, float angleSpread,
+             Fn&& fn) {
+        runChunks(sampler, rng, n, leftHandBias, mode, angleSpread, [&](const ThreeBodyChunk& c) {
+            for (int i = 0; i < c.size; ++i) fn(sample(i));
+        });
+    }
+
+    // Same events as run(), handed out as fn(chunk) with up to kChunk at a time.
+    template <class Fn>
+    void runChunks(BlockSampler& sampler, std::mt19937& rng, std::uint64_t n, float leftHandBias, Mode mode,
+                   float angleSpread, Fn&& fn) {
+        std::uniform_real_distribution<float> u01(0.f, 1.f);
+        for (std::uint64_t first = 0; first < n; first += kChunk) {
+            const int m = static_cast<int>(std::min<std::uint64_t>(kChunk, n - first));
+            for (int i = 0; i < m; ++i) {
+                DecayDraws d = sampler.nextDraws();
+                uAngle_[i] = d.uAngle;
+                uLeft_[i] = d.uLeft;
+                protonSign_[i] = d.protonSign;
+                neutronSign_[i] = d.neutronSign;
+                channel_[i] = d.channel;
+                uEnergy_[i] = u01(rng);
+                uCos_[i] = u01(rng);
+                uSide_[i] = u01(rng);
+                uTilt_[i] = u01(rng);
+            }
+            kinematics(m, leftHandBias, mode, angleSpread);
+            fn(ThreeBodyChunk{m, dirEx_, dirEy_, spinEx_, spinEy_, dirNux_, dirNuy_, spinNux_, spinNuy_, energy_,
+                              recoilx_, recoily_, protonSign_, neutronSign_, lNeeded_, channel_});
+        }
+    }
+
+private:
+    // Same steps as decayGeometry(), applyThreeBody() and applyMode(). The
+    // channel parameters are first gathered from the table into per-event
+    // arrays, so the loops below read them like any other input.
+    void kinematics(int m, float leftHandBias, Mode mode, float angleSpread) {
+        const DecayChannels& ch = *channels_;
+        bool oneChannel = true;
+        for (int i = 0; i < m; ++i) {
+            const std::size_t id = channel_[i];
+            oneChannel &= channel_[i] == channel_[0];
+            hCharged_[i] = ch.chargedHelicity[id];
+            hNeutral_[i] = ch.neutralHelicity[id];
+            side_[i] = ch.chargedSide[id];
+            parentTwoJ_[i] = ch.parentTwoJ[id];
+            daughterTwoJ_[i] = ch.daughterTwoJ[id];
+            q_[i] = ch.q[id];
+            corrA_[i] = ch.correlationA[id];
+            asymA_[i] = ch.asymmetryA[id];
+        }
+
+        for (int i = 0; i < m; ++i) {
+            float a = -angleSpread + (angleSpread + angleSpread) * uAngle_[i];
+            float x = std::cos(a), y = std::sin(a);
+            float l = std::sqrt(x * x + y * y);
+            dirEx_[i] = x / l;
+            dirEy_[i] = y / l;
+
+            // vnorm(+-dirE), the channel's helicity with probability leftHandBias
+            float sign = uLeft_[i] < leftHandBias ? hCharged_[i] : -hCharged_[i];
+            float sx = sign * dirEx_[i], sy = sign * dirEy_[i];
+            float sl = std::sqrt(sx * sx + sy * sy);
+            spinEx_[i] = sx / sl;
+            spinEy_[i] = sy / sl;
+        }
+
+        // Usually the whole chunk is one channel and one spectrum.
+        if (oneChannel && ch.spectrum[channel_[0]]) {
+            const BetaSpectrum& spectrum = *ch.spectrum[channel_[0]];
+            for (int i = 0; i < m; ++i) energy_[i] = spectrum.sample(uEnergy_[i]);
+        } else {
+            for (int i = 0; i < m; ++i) {
+                const BetaSpectrum* spectrum = ch.spectrum[channel_[i]];
+                energy_[i] = spectrum ? spectrum->sample(uEnergy_[i]) : 0.f;
+            }
+        }
+
+        for (int i = 0; i < m; ++i) {
+            float t = energy_[i];
+            float gamma = 1.f + t / kElectronMass;
+            float beta = std::sqrt(1.f - 1.f / (gamma * gamma));
+
+            // Beta asymmetry: mirror the electron to the side picked by uTilt.
+            float kTilt = asymA_[i] * beta * std::abs(dirEy_[i]);
+            int side = uTilt_[i] < 0.5f * (1.f + kTilt) ? neutronSign_[i] : -neutronSign_[i];
+            float flip = (dirEy_[i] >= 0.f ? 1 : -1) != side ? -1.f : 1.f;
+            dirEy_[i] *= flip;
+            spinEy_[i] *= flip;
+
+            float k = corrA_[i] * beta;
+            float c0 = 0.5f - 0.25f * k - uCos_[i];
+            float disc = 0.25f - k * c0;
+            float c = -2.f * c0 / (0.5f + std::sqrt(std::max(0.f, disc)));
+            c = std::min(1.f, std::max(-1.f, c));
+            float sn = std::sqrt(std::max(0.f, 1.f - c * c)) * (uSide_[i] < 0.5f ? 1.f : -1.f);
+
+            float nx = c * dirEx_[i] - sn * dirEy_[i];
+            float ny = sn * dirEx_[i] + c * dirEy_[i];
+            float nl = std::sqrt(nx * nx + ny * ny);
+            nx = nl <= 1e-6f ? 0.f : nx / nl;
+            ny = nl <= 1e-6f ? 0.f : ny / nl;
+            dirNux_[i] = nx;
+            dirNuy_[i] = ny;
+            float hx = nx * hNeutral_[i], hy = ny * hNeutral_[i];
+            float ml = std::sqrt(hx * hx + hy * hy);
+            spinNux_[i] = ml <= 1e-6f ? 0.f : hx / ml;
+            spinNuy_[i] = ml <= 1e-6f ? 0.f : hy / ml;
+
+            float pE = std::sqrt(t * (t + 2.f * kElectronMass));
+            float pNu = q_[i] - t;
+            recoilx_[i] = -(dirEx_[i] * pE + nx * pNu);
+            recoily_[i] = -(dirEy_[i] * pE + ny * pNu);
+        }
+
+        if (mode == Mode::SpinOnly) {
+            for (int i = 0; i < m; ++i) {
+                float x = -spinEx_[i], y = -spinEy_[i];
+                float l = std::sqrt(x * x + y * y);
+                spinNux_[i] = l <= 1e-6f ? 0.f : x / l;
+                spinNuy_[i] = l <= 1e-6f ? 0.f : y / l;
+            }
+        }
+
+        for (int i = 0; i < m; ++i) {
+            int sE = spinEy_[i] >= 0.f ? 1 : -1;
+            int sN = spinNuy_[i] >= 0.f ? 1 : -1;
+            lNeeded_[i] = parentTwoJ_[i] * neutronSign_[i] - (daughterTwoJ_[i] * protonSign_[i] + sN) + side_[i] * sE;
+        }
+    }
+
+    DecaySample sample(int i) const {
+        DecaySample s;
+        s.dirE = {dirEx_[i], dirEy_[i]};
+        s.spinE = {spinEx_[i], spinEy_[i]};
+        s.dirNu = {dirNux_[i], dirNuy_[i]};
+        s.spinNu = {spinNux_[i], spinNuy_[i]};
+        s.protonSpinSign = protonSign_[i];
+        s.neutronSpinSign = neutronSign_[i];
+        s.L_needed = lNeeded_[i];
+        s.channel = channel_[i];
+        s.electronT = channels_->spectrum[channel_[i]] ? energy_[i] : -1.f;
+        s.recoil = {recoilx_[i], recoily_[i]};
+        return s;
+    }
+
+    // Draws
+    alignas(kLineAlign) float uAngle_[kChunk];
+    alignas(kLineAlign) float uLeft_[kChunk];
+    alignas(kLineAlign) float uEnergy_[kChunk];
+    alignas(kLineAlign) float uCos_[kChunk];
+    alignas(kLineAlign) float uSide_[kChunk];
+    alignas(kLineAlign) float uTilt_[kChunk];
+    alignas(kLineAlign) int protonSign_[kChunk];
+    alignas(kLineAlign) int neutronSign_[kChunk];
+    alignas(kLineAlign) std::uint8_t channel_[kChunk];
+
+    // Channel parameters per event
+    const DecayChannels* channels_ = &decayChannels();
+    alignas(kLineAlign) float hCharged_[kChunk], hNeutral_[kChunk];
+    alignas(kLineAlign) float q_[kChunk], corrA_[kChunk], asymA_[kChunk];
+    alignas(kLineAlign) int side_[kChunk], parentTwoJ_[kChunk], daughterTwoJ_[kChunk];
+
+    // Results
+    alignas(kLineAlign) float dirEx_[kChunk], dirEy_[kChunk];
+    alignas(kLineAlign) float spinEx_[kChunk], spinEy_[kChunk];
+    alignas(kLineAlign) float dirNux_[kChunk], dirNuy_[kChunk];
+    alignas(kLineAlign) float spinNux_[kChunk], spinNuy_[kChunk];
+    alignas(kLineAlign) float energy_[kChunk];
+    alignas(kLineAlign) float recoilx_[kChunk], recoily_[kChunk];
+    alignas(kLineAlign) int lNeeded_[kChunk];
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+// Opt-in timeline tracer writing Chrome trace-event JSON (chrome://tracing,
+// https://ui.perfetto.dev). Every thread appends to its own buffer without
+// locks; a thread only takes the registry lock on its first event, to claim a
+// buffer, and on exit, to hand it back. A thread that ends leaves its buffer
+// (and its row in the viewer) to the next new thread, so short-lived pools
+// add rows only up to the most threads alive at once. Scopes are recorded as
+// complete ("X") events, i.e. one begin/end pair each. When tracing is off a
+// scope costs one relaxed load.
+//
+// traceWrite() reads every buffer, so call it once the traced threads have
+// finished (pools joined), e.g. on exit.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct TraceEvent {
+    const char* name;   // string literal
+    std::int64_t arg;   // shown as args.i unless negative (block, frame or tile index)
+    std::uint64_t tsNs; // since traceStart()
+    std::uint64_t durNs;
+};
+
+struct TraceBuffer {
+    static constexpr std::size_t kMaxEvents = std::size_t{1} << 21; // per thread; later events are dropped
+
+    unsigned tid = 0;
+    std::string name;
+    std::vector<TraceEvent> events;
+    std::uint64_t dropped = 0;
+};
+
+struct TraceRegistry {
+    std::atomic<bool> enabled{false};
+    std::chrono::steady_clock::time_point epoch;
+    std::mutex m;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+    std::vector<TraceBuffer*> idle; // owned by buffers, their threads have exited
+};
+
+inline TraceRegistry& traceRegistry() {
+    static TraceRegistry r;
+    return r;
+}
+
+inline bool traceEnabled() { return traceRegistry().enabled.load(std::memory_order_relaxed); }
+
+inline void traceStart() {
+    TraceRegistry& r = traceRegistry();
+    r.epoch = std::chrono::steady_clock::now();
+    r.enabled.store(true, std::memory_order_release);
+}
+
+inline std::uint64_t traceNow() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceRegistry().epoch).count());
+}
+
+// Holds a thread's buffer and hands it back to the registry when the thread
+// exits.
+struct TraceLease {
+    TraceBuffer* buffer = nullptr;
+
+    ~TraceLease() {
+        if (!buffer) return;
+        TraceRegistry& r = traceRegistry();
+        std::lock_guard<std::mutex> lock(r.m);
+        r.idle.push_back(buffer);
+    }
+};
+
+// This thread's buffer: on first use an exited thread's, else a new one.
+inline TraceBuffer& traceBuffer() {
+    thread_local TraceLease lease;
+    if (!lease.buffer) {
+        TraceRegistry& r = traceRegistry();
+        std::lock_guard<std::mutex> lock(r.m);
+        if (!r.idle.empty()) {
+            lease.buffer = r.idle.back();
+            r.idle.pop_back();
+        } else {
+            r.buffers.push_back(std::make_unique<TraceBuffer>());
+            lease.buffer = r.buffers.back().get();
+            lease.buffer->tid = static_cast<unsigned>(r.buffers.size());
+            lease.buffer->name = "thread " + std::to_string(lease.buffer->tid);
+        }
+    }
+    return *lease.buffer;
+}
+
+// Buffers (rows) registered so far.
+inline std::size_t traceBufferCount() {
+    TraceRegistry& r = traceRegistry();
+    std::lock_guard<std::mutex> lock(r.m);
+    return r.buffers.size();
+}
+
+// Label for this thread's row in the viewer.
+inline void traceThreadName(const std::string& name) {
+    if (traceEnabled()) traceBuffer().name = name;
+}
+
+inline void traceRecord(const char* name, std::int64_t arg, std::uint64_t begin, std::uint64_t end) {
+    TraceBuffer& b = traceBuffer();
+    if (b.events.size() >= TraceBuffer::kMaxEvents) {
+        ++b.dropped;
+        return;
+    }
+    if (b.events.capacity() == 0) b.events.reserve(4096);
+    b.events.push_back(TraceEvent{name, arg, begin, end - begin});
+}
+
+// Records [construction, destruction) under name. next() closes the current
+// span and opens the following one, for consecutive phases of one function.
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, std::int64_t arg = -1) : name_(name), arg_(arg) {
+        if (traceEnabled()) begin_ = traceNow();
+        else name_ = nullptr;
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+    ~TraceScope() { end(); }
+
+    void next(const char* name, std::int64_t arg = -1) {
+        end();
+        if (!traceEnabled()) return;
+        name_ = name;
+        arg_ = arg;
+        begin_ = traceNow();
+    }
+
+    void end() {
+        if (!name_) return;
+        traceRecord(name_, arg_, begin_, traceNow());
+        name_ = nullptr;
+    }
+
+private:
+
+    const char* name_;
+    std::int64_t arg_;
+    std::uint64_t begin_ = 0;
+};
+
+inline void traceJsonString(std::FILE* f, const std::string& s) {
+    std::fputc('"', f);
+    for (char c : s) {
+        if (c == '"' || c == '\\') std::fputc('\\', f);
+        if (static_cast<unsigned char>(c) >= 0x20) std::fputc(c, f);
+    }
+    std::fputc('"', f);
+}
+
+// Writes everything recorded so far and stops tracing. False on I/O errors.
+inline bool traceWrite(const std::string& path, std::uint64_t* eventsWritten = nullptr) {
+    TraceRegistry& r = traceRegistry();
+    r.enabled.store(false, std::memory_order_relaxed);
+
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+
+    std::lock_guard<std::mutex> lock(r.m);
+    std::uint64_t n = 0;
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto& b : r.buffers) {
+        std::fprintf(f, "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":", first ? "" : ",\n",
+                     b->tid);
+        traceJsonString(f, b->name);
+        std::fprintf(f, "}}");
+        first = false;
+
+        for (const TraceEvent& e : b->events) {
+            std::fprintf(f, ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f", b->tid, e.name,
+                         static_cast<double>(e.tsNs) / 1000.0, static_cast<double>(e.durNs) / 1000.0);
+            if (e.arg >= 0) std::fprintf(f, ",\"args\":{\"i\":%lld}", static_cast<long long>(e.arg));
+            std::fputc('}', f);
+            ++n;
+        }
+        if (b->dropped) {
+            std::fprintf(f, ",\n{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"name\":\"trace buffer full, %llu dropped\",\"ts\":%.3f}",
+                         b->tid, static_cast<unsigned long long>(b->dropped),
+                         b->events.empty() ? 0.0 : static_cast<double>(b->events.back().tsNs) / 1000.0);
+        }
+    }
+    std::fprintf(f, "\n]}\n");
+
+    if (eventsWritten) *eventsWritten = n;
+    bool ok = !std::ferror(f);
+    return std::fclose(f) == 0 && ok;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// The font for labels, the HUD and tooltips. When the build found a TrueType
+// file (see BETADECAY_FONT in CMakeLists.txt) its bytes are compiled into the
+// binary and nothing is read from disk; otherwise the old lookup of Arial.ttf
+// or DejaVuSans.ttf in the working directory is the fallback.
+
+#include <SFML/Graphics.hpp>
+
+#include <cstddef>
+
+#ifdef BETADECAY_EMBEDDED_FONT
+inline const unsigned char kEmbeddedFont[] = {
+#include "embedded_font.inc"
+};
+#endif
+
+inline bool loadUiFont(sf::Font& font) {
+#ifdef BETADECAY_EMBEDDED_FONT
+    if (font.openFromMemory(kEmbeddedFont, sizeof(kEmbeddedFont))) return true;
+#endif
+    return font.openFromFile("Arial.ttf") || font.openFromFile("DejaVuSans.ttf");
+}
+
+// SFML rasterizes a glyph into the font's atlas the first time it is drawn at
+// a given size and outline, which made the first HUD frame and every first
+// tooltip hitch. Bake all printable ASCII at the styles the UI draws with
+// (labels 14 with a 2 px outline, panels 14/15/16, population and spectrum
+// axes 12, tooltips 15/16) up front.
+// Needs a GL context, so call it after the window exists.
+inline void prebakeGlyphs(const sf::Font& font) {
+    struct Style {
+        unsigned size;
+        float outline;
+    };
+    const Style styles[] = {{12, 0.f}, {14, 0.f}, {14, 2.f}, {15, 0.f}, {16, 0.f}};
+    for (const Style& s : styles) {
+        for (char32_t c = 0x20; c < 0x7f; ++c) font.getGlyph(c, s.size, false, s.outline);
+    }
+}
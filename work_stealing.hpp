@@ -0,0 +1,149 @@
+#pragma once
+
+// Small work-stealing scheduler for batch jobs made of independent tasks with
+// uneven cost. Each worker has its own deque: it takes work from the back of
+// its own deque and, when that runs dry, steals from the front of another
+// worker's. Each deque has its own lock, so the only contention is a thief
+// and an owner meeting on the same deque, which is rare.
+
+#include "histograms.hpp"
+#include "trace.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+inline unsigned batchThreads(unsigned requested) {
+    if (requested) return requested;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw ? hw : 1;
+}
+
+class TaskDeque {
+public:
+    void pushBack(std::size_t t) {
+        std::lock_guard<std::mutex> lock(m_);
+        q_.push_back(t);
+    }
+
+    bool popBack(std::size_t& t) {
+        std::lock_guard<std::mutex> lock(m_);
+        if (q_.empty()) return false;
+        t = q_.back();
+        q_.pop_back();
+        return true;
+    }
+
+    bool stealFront(std::size_t& t) {
+        std::lock_guard<std::mutex> lock(m_);
+        if (q_.empty()) return false;
+        t = q_.front();
+        q_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex m_;
+    std::deque<std::size_t> q_;
+};
+
+// Workers that stay up between runs, for callers that schedule many small
+// batches (a frame's raster tiles, waves of population blocks) and should
+// not start and join a thread per worker each time. run() deals the tasks
+// round-robin over the workers' deques, wakes them and returns once every
+// task has run; stealing evens out the rest.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads) : threads_(threads ? threads : 1), slots_(new Slot[threads_]) {
+        workers_.reserve(threads_);
+        for (unsigned w = 0; w < threads_; ++w) workers_.emplace_back([this, w] { work(w); });
+    }
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& th : workers_) th.join();
+    }
+
+    unsigned threads() const { return threads_; }
+
+    // Runs fn(task, worker) for every task in [0, taskCount). One run at a time.
+    template <class Fn>
+    void run(std::size_t taskCount, Fn&& fn) {
+        if (taskCount == 0) return;
+        for (std::size_t t = 0; t < taskCount; ++t) slots_[t % threads_].q.pushBack(t);
+
+        std::unique_lock<std::mutex> lock(m_);
+        call_ = [](void* f, std::size_t t, unsigned w) { (*static_cast<std::remove_reference_t<Fn>*>(f))(t, w); };
+        fn_ = const_cast<void*>(static_cast<const void*>(&fn));
+        busy_ = threads_;
+        ++generation_;
+        wake_.notify_all();
+        done_.wait(lock, [this] { return busy_ == 0; });
+    }
+
+private:
+    struct alignas(kCacheLine) Slot {
+        TaskDeque q;
+    };
+
+    void work(unsigned w) {
+        traceThreadName("pool worker " + std::to_string(w));
+        std::uint64_t seen = 0;
+        for (;;) {
+            void (*call)(void*, std::size_t, unsigned) = nullptr;
+            void* fn = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+                call = call_;
+                fn = fn_;
+            }
+
+            // Tasks never spawn tasks, so once every deque is empty this worker is done.
+            std::size_t t = 0;
+            for (;;) {
+                bool got = slots_[w].q.popBack(t);
+                for (unsigned k = 1; !got && k < threads_; ++k) got = slots_[(w + k) % threads_].q.stealFront(t);
+                if (!got) break;
+                call(fn, t, w);
+            }
+
+            std::lock_guard<std::mutex> lock(m_);
+            if (--busy_ == 0) done_.notify_one();
+        }
+    }
+
+    const unsigned threads_;
+    std::unique_ptr<Slot[]> slots_;
+    std::vector<std::thread> workers_;
+
+    std::mutex m_;
+    std::condition_variable wake_, done_;
+    std::uint64_t generation_ = 0;
+    unsigned busy_ = 0;
+    bool stop_ = false;
+    void (*call_)(void*, std::size_t, unsigned) = nullptr;
+    void* fn_ = nullptr;
+};
+
+// Runs fn(task, worker) for every task in [0, taskCount) on `threads` workers
+// started for this call alone, for one-off jobs such as a whole batch run.
+template <class Fn>
+void runWorkStealing(std::size_t taskCount, unsigned threads, Fn&& fn) {
+    WorkStealingPool pool(threads);
+    pool.run(taskCount, fn);
+}